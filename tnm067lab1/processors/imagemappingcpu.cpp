@@ -1,13 +1,45 @@
 #include <modules/tnm067lab1/processors/imagemappingcpu.h>
-#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <modules/tnm067lab1/utils/pipeline.h>
 #include <inviwo/core/common/inviwoapplication.h>
 #include <inviwo/core/datastructures/image/layerramprecision.h>
-#include <inviwo/core/util/indexmapper.h>
+#include <inviwo/core/io/datareaderfactory.h>
+#include <inviwo/core/io/datawriterfactory.h>
+#include <inviwo/core/util/filesystem.h>
 #include <inviwo/core/util/imageramutils.h>
+#include <inviwo/core/util/stringconversion.h>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <type_traits>
 
 namespace inviwo {
 
+namespace detail {
+
+// Floating point data is binned over its range, 8 and 16 bit data has one bin per value
+constexpr size_t floatHistogramBins = 4096;
+
+TNM067::ValueStatistics layerStatistics(const LayerRAM& layer, bool histogram) {
+    return layer.dispatch<TNM067::ValueStatistics>([&](const auto rep) {
+        using T = std::remove_cv_t<std::remove_pointer_t<decltype(rep->getDataTyped())>>;
+        if constexpr (TNM067::hasValueStatistics<T>()) {
+            const size2_t dims = rep->getDimensions();
+            const size_t chunks = std::max(1u, std::thread::hardware_concurrency());
+            auto parallelFor = [](size_t count, auto f) {
+                util::forEachPixelParallel(size2_t{1, count}, [&](size2_t pos) { f(pos.y); });
+            };
+            return TNM067::computeStatistics(rep->getDataTyped(), dims.x * dims.y, chunks,
+                                             histogram ? floatHistogramBins : 0, parallelFor);
+        } else {
+            return TNM067::ValueStatistics{};
+        }
+    });
+}
+
+}  // namespace detail
+
 // The Class Identifier has to be globally unique. Use a reverse DNS naming scheme
 const ProcessorInfo ImageMappingCPU::processorInfo_{
     "org.inviwo.ImageMappingCPU",  // Class identifier
@@ -32,7 +64,19 @@ ImageMappingCPU::ImageMappingCPU()
                FloatVec4Property{"color7", "Color 7", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
                FloatVec4Property{"color8", "Color 8", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
                FloatVec4Property{"color9", "Color 9", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
-               FloatVec4Property{"color10", "Color 10", vec4(1), vec4(0, 0, 0, 1), vec4(1)}}) {
+               FloatVec4Property{"color10", "Color 10", vec4(1), vec4(0, 0, 0, 1), vec4(1)}})
+    , valueRange_("valueRange", "Value Range",
+                  {{"datatype", "Data Type Range", ValueRange::DataType},
+                   {"minmax", "Data Min/Max", ValueRange::MinMax},
+                   {"percentile", "Data Percentiles", ValueRange::Percentile}})
+    , clipPercent_("clipPercent", "Clipped Percent", 1.0f, 0.0f, 25.0f)
+    , batch_("batch", "Batch Mapping")
+    , inputDirectory_("inputDirectory", "Input Directory")
+    , outputDirectory_("outputDirectory", "Output Directory")
+    , queueSize_("queueSize", "Queue Size", 4, 1, 64)
+    , mapSequence_("mapSequence", "Map Sequence")
+    , cancelSequence_("cancelSequence", "Cancel")
+    , sequenceJob_([this](float progress) { updateProgress(progress); }) {
 
     addPort(inport_);
     addPort(outport_);
@@ -52,31 +96,209 @@ ImageMappingCPU::ImageMappingCPU()
 
     numColors_.onChange(colorVisibility);
     colorVisibility();
+
+    addProperty(valueRange_);
+    addProperty(clipPercent_);
+    valueRange_.onChange(
+        [this]() { clipPercent_.setVisible(valueRange_ == ValueRange::Percentile); });
+    clipPercent_.setVisible(valueRange_ == ValueRange::Percentile);
+
+    batch_.addProperty(inputDirectory_);
+    batch_.addProperty(outputDirectory_);
+    batch_.addProperty(queueSize_);
+    batch_.addProperty(mapSequence_);
+    batch_.addProperty(cancelSequence_);
+    mapSequence_.onChange([this]() { mapSequence(); });
+    cancelSequence_.onChange([this]() { sequenceJob_.cancel(); });
+    addProperty(batch_);
+}
+
+std::vector<vec4> ImageMappingCPU::getBaseColors() const {
+    std::vector<vec4> baseColors;
+    for (size_t i = 0; i < numColors_.get(); i++) {
+        baseColors.push_back(colors_[i].get());
+    }
+    return baseColors;
+}
+
+dvec2 ImageMappingCPU::getRange(const LayerRAM& layer) {
+    if (valueRange_ == ValueRange::DataType) return dvec2(0.0, 1.0);
+
+    // Only floating point data needs a second read for its histogram, skip it unless it is used
+    const bool percentile = valueRange_ == ValueRange::Percentile;
+    if (!stats_ || (percentile && stats_->count > 0 && stats_->histogram.empty())) {
+        stats_ = detail::layerStatistics(layer, percentile);
+        if (stats_->count == 0) {
+            LogWarn("No data range for " << layer.getDataFormat()->getString()
+                                         << " images, using the range of the data type");
+        }
+    }
+    if (stats_->count == 0) return dvec2(0.0, 1.0);
+    if (!percentile) return dvec2(stats_->min, stats_->max);
+
+    const double clip = clipPercent_.get() / 100.0;
+    return dvec2(stats_->percentile(clip), stats_->percentile(1.0 - clip));
 }
 
 void ImageMappingCPU::process() {
     auto inImg = inport_.getData();
-    auto img = std::make_shared<Image>(inImg->getDimensions(), DataVec4UInt8::get());
-    auto outRep = static_cast<LayerRAMPrecision<glm::u8vec4>*>(
-        img->getColorLayer()->getEditableRepresentation<LayerRAM>());
-    glm::u8vec4* outPixels = outRep->getDataTyped();
-    util::IndexMapper2D index(inImg->getDimensions());
+    const size2_t dims = inImg->getDimensions();
+    // The colors are kept between frames and updated in place while the size matches
+    const bool resized = dims != colorDims_;
+    if (resized) {
+        colors_.assign(dims.x * dims.y, glm::u8vec4(0));
+        colorDims_ = dims;
+    }
 
-    ScalarToColorMapping map;
-    for (size_t i = 0; i < numColors_.get(); i++) {
-        map.addBaseColors(colors_[i].get());
+    const auto inRep = inImg->getColorLayer()->getRepresentation<LayerRAM>();
+    const bool inputChanged = inport_.isChanged();
+    if (inputChanged) stats_.reset();
+    const bool colorsChanged = mapping_.setBaseColors(getBaseColors());
+    const bool rangeChanged = mapping_.setRange(getRange(*inRep));
+
+    bool changed = resized;
+    if (inputChanged || resized) {
+        // Only the pixels whose values differ from the previous input are recolored
+        const auto regions = incremental_.update(*inRep, mapping_, colors_.data(),
+                                                 resized || colorsChanged || rangeChanged);
+        changed = changed || !regions.empty();
+    } else if (colorsChanged || rangeChanged) {
+        incremental_.recolor(mapping_, colors_.data());
+        changed = true;
     }
 
-    inImg->getColorLayer()->getRepresentation<LayerRAM>()->dispatch<void>([&](const auto inRep) {
-        auto inPixels = inRep->getDataTyped();
-        util::forEachPixelParallel(*inRep, [&](size2_t pos) {
-            auto i = index(pos);
-            float inPixelVal = util::glm_convert_normalized<float>(inPixels[i]);
-            outPixels[i] = map.sample(inPixelVal) * 255.f;
-        });
-    });
+    // A published image is never changed, downstream processors may still be using it. New
+    // colors are copied into a new image, a frame without any passes on the last one.
+    if (changed || !img_) {
+        img_ = std::make_shared<Image>(dims, DataVec4UInt8::get());
+        auto outRep = static_cast<LayerRAMPrecision<glm::u8vec4>*>(
+            img_->getColorLayer()->getEditableRepresentation<LayerRAM>());
+        std::copy(colors_.begin(), colors_.end(), outRep->getDataTyped());
+    }
+    outport_.setData(img_);
+}
+
+void ImageMappingCPU::mapSequence() {
+    if (sequenceJob_.running()) {
+        LogWarn("Already mapping a sequence, cancel it first");
+        return;
+    }
+    const std::string inDir = inputDirectory_.get();
+    const std::string outDir = outputDirectory_.get();
+    if (!filesystem::directoryExists(inDir)) {
+        LogError("Input directory \"" << inDir << "\" does not exist");
+        return;
+    }
+    if (outDir.empty() || outDir == inDir) {
+        LogError("Choose an output directory different from the input directory");
+        return;
+    }
+    filesystem::createDirectoryRecursively(outDir);
 
-    outport_.setData(img);
+    auto app = InviwoApplication::getPtr();
+    auto readers = app->getDataReaderFactory();
+    auto writers = app->getDataWriterFactory();
+
+    // Every image that can be both read and written, in name order
+    auto files = filesystem::getDirectoryContents(inDir);
+    files.erase(std::remove_if(files.begin(), files.end(),
+                               [&](const std::string& file) {
+                                   const auto ext = toLower(filesystem::getFileExtension(file));
+                                   return !readers->getReaderForTypeAndExtension<Layer>(ext) ||
+                                          !writers->getWriterForTypeAndExtension<Layer>(ext);
+                               }),
+                files.end());
+    std::sort(files.begin(), files.end());
+
+    // A copy of the tables, with the value range of the connected input for every frame
+    LayerColorMapping mapping = mapping_;
+    mapping.setBaseColors(getBaseColors());
+
+    // The store stage runs on a thread of the pool and the loader on one more thread. Mapping
+    // threads only get the cores that neither the pool nor the loader use, so the sequence does
+    // not slow down the rest of the network. Each mapping thread maps a whole frame on its own,
+    // so frames rather than rows are spread over the cores.
+    const size_t cores = std::thread::hardware_concurrency();
+    const size_t used = app->getThreadPool().getSize() + 1;
+    const size_t mapThreads = cores > used ? cores - used : 1;
+    const size_t queueSize = queueSize_.get();
+
+    sequenceJob_.start([this, readers, writers, files = std::move(files),
+                        mapping = std::move(mapping), inDir, outDir, mapThreads,
+                        queueSize](const TNM067::BackgroundJob::Progress& progress) {
+        std::atomic<size_t> failed{0};
+        size_t written = 0;
+        size_t done = 0;
+
+        try {
+            TNM067::runPipeline(
+                files.size(), queueSize, mapThreads,
+                [&](size_t i) -> std::shared_ptr<Layer> {
+                    // After a cancel the remaining frames pass through the stages without any work
+                    if (progress.cancelled()) return nullptr;
+                    const auto ext = toLower(filesystem::getFileExtension(files[i]));
+                    auto reader = readers->getReaderForTypeAndExtension<Layer>(ext);
+                    if (!reader) {
+                        LogError("No reader for " << files[i]);
+                        ++failed;
+                        return nullptr;
+                    }
+                    try {
+                        auto layer = reader->readData(inDir + "/" + files[i]);
+                        // Read the pixels here, on the loading thread, rather than when mapping
+                        layer->getRepresentation<LayerRAM>();
+                        return layer;
+                    } catch (const Exception& e) {
+                        LogError("Could not read " << files[i] << ": " << e.getMessage());
+                        ++failed;
+                        return nullptr;
+                    }
+                },
+                [&](std::shared_ptr<Layer> in) -> std::shared_ptr<Layer> {
+                    if (!in || progress.cancelled()) return nullptr;
+                    auto out = std::make_shared<Layer>(in->getDimensions(), DataVec4UInt8::get());
+                    auto outRep = static_cast<LayerRAMPrecision<glm::u8vec4>*>(
+                        out->getEditableRepresentation<LayerRAM>());
+                    mapping.map(*in->getRepresentation<LayerRAM>(), outRep->getDataTyped(), false);
+                    return out;
+                },
+                [&](size_t i, std::shared_ptr<Layer> out) {
+                    progress.report(static_cast<float>(++done) / files.size());
+                    if (!out || progress.cancelled()) return;
+                    const auto ext = toLower(filesystem::getFileExtension(files[i]));
+                    auto writer = writers->getWriterForTypeAndExtension<Layer>(ext);
+                    if (!writer) {
+                        LogError("No writer for " << files[i]);
+                        ++failed;
+                        return;
+                    }
+                    try {
+                        writer->setOverwrite(Overwrite::Yes);
+                        writer->writeData(out.get(), outDir + "/" + files[i]);
+                        ++written;
+                    } catch (const Exception& e) {
+                        LogError("Could not write " << files[i] << ": " << e.getMessage());
+                        ++failed;
+                    }
+                });
+        } catch (const std::exception& e) {
+            // A stage failed on something other than a single image, e.g. ran out of memory
+            progress.report(0.0f);
+            LogError("Stopped mapping the images from " << inDir << " after " << written << " of "
+                                                       << files.size() << ": " << e.what());
+            return;
+        }
+
+        if (progress.cancelled()) {
+            progress.report(0.0f);
+            LogInfo("Cancelled after mapping " << written << " of " << files.size()
+                                               << " images from " << inDir << " to " << outDir);
+        } else {
+            LogInfo("Mapped " << written << " of " << files.size() << " images from " << inDir
+                              << " to " << outDir
+                              << (failed > 0 ? ", see the errors above for the rest" : ""));
+        }
+    });
 }
 
 }  // namespace inviwo
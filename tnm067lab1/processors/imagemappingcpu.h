@@ -2,13 +2,41 @@
 
 #include <modules/tnm067lab1/tnm067lab1moduledefine.h>
 #include <inviwo/core/processors/processor.h>
+#include <inviwo/core/processors/progressbarowner.h>
 #include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/properties/compositeproperty.h>
+#include <inviwo/core/properties/directoryproperty.h>
+#include <inviwo/core/properties/buttonproperty.h>
 #include <inviwo/core/ports/imageport.h>
+#include <modules/tnm067lab1/utils/layercolormapping.h>
+#include <modules/tnm067lab1/utils/incrementalcolormapping.h>
+#include <modules/tnm067lab1/utils/valuestatistics.h>
+#include <modules/tnm067lab1/utils/backgroundjob.h>
+
+#include <optional>
+#include <vector>
 
 namespace inviwo {
 
-class IVW_MODULE_TNM067LAB1_API ImageMappingCPU : public Processor {
+/**
+ * \class ImageMappingCPU
+ * \brief Maps the scalar values of an image to colors interpolated from a set of base colors
+ * The colors span either the full range of the data type, the min/max of the input or the input
+ * range with a percentage of the values clipped at both ends. The data driven ranges come from
+ * one parallel pass over the input that is cached until the input changes.
+ * The colors are kept between frames: a new input only recolors the pixels whose values changed
+ * and new colors remap the cached normalized values of the input. Every frame with changed colors
+ * is published as a new image, so an image that was passed on is never changed afterwards.
+ * Besides the connected input, Map Sequence maps every image in the input directory and writes
+ * the result with the same name to the output directory. Loading, mapping and writing overlap
+ * and at most about twice Queue Size frames are held in memory at once. The sequence is mapped in
+ * the background with its progress on the progress bar and can be stopped with Cancel.
+ */
+class IVW_MODULE_TNM067LAB1_API ImageMappingCPU : public Processor, public ProgressBarOwner {
 public:
+    enum class ValueRange { DataType, MinMax, Percentile };
+
     ImageMappingCPU();
     virtual ~ImageMappingCPU() = default;
 
@@ -18,11 +46,34 @@ public:
     static const ProcessorInfo processorInfo_;
 
 private:
+    std::vector<vec4> getBaseColors() const;
+    dvec2 getRange(const LayerRAM& layer);
+    void mapSequence();
+
     ImageInport inport_;
     ImageOutport outport_;
 
     IntSizeTProperty numColors_;
     std::array<FloatVec4Property, 10> colors_;
+
+    TemplateOptionProperty<ValueRange> valueRange_;
+    FloatProperty clipPercent_;
+
+    CompositeProperty batch_;
+    DirectoryProperty inputDirectory_;
+    DirectoryProperty outputDirectory_;
+    IntSizeTProperty queueSize_;
+    ButtonProperty mapSequence_;
+    ButtonProperty cancelSequence_;
+
+    LayerColorMapping mapping_;  // kept between frames, its tables only change with the colors
+    std::optional<TNM067::ValueStatistics> stats_;  // of the current input, reset when it changes
+    IncrementalColorMapping incremental_;
+
+    std::vector<glm::u8vec4> colors_;  // of the last frame, recolored where the input changed
+    size2_t colorDims_{0};
+    std::shared_ptr<Image> img_;  // last published output, never changed after setData
+    TNM067::BackgroundJob sequenceJob_;  // last, so that a running sequence is stopped first
 };
 
 }  // namespace inviwo
@@ -0,0 +1,136 @@
+#include <modules/tnm067lab1/processors/imagepyramid.h>
+#include <modules/tnm067lab1/utils/interpolationmethods.h>
+#include <modules/tnm067lab1/utils/resampling.h>
+#include <inviwo/core/datastructures/image/layerram.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+#include <inviwo/core/util/imageramutils.h>
+
+namespace inviwo {
+
+namespace detail {
+
+template <typename T>
+void downsampleHalf(const LayerRAMPrecision<T>& inputImage, LayerRAMPrecision<T>& outputImage) {
+    const size2_t inSize = inputImage.getDimensions();
+    const size2_t outSize = outputImage.getDimensions();
+    const T* inPixels = inputImage.getDataTyped();
+    T* outPixels = outputImage.getDataTyped();
+
+    util::forEachPixelParallel(outputImage, [&](size2_t pos) {
+        const size_t x0 = std::min(2 * pos.x, inSize.x - 1);
+        const size_t x1 = std::min(2 * pos.x + 1, inSize.x - 1);
+        const size_t y0 = std::min(2 * pos.y, inSize.y - 1);
+        const size_t y1 = std::min(2 * pos.y + 1, inSize.y - 1);
+        outPixels[pos.x + pos.y * outSize.x] = TNM067::Resampling::average4(
+            inPixels[x0 + y0 * inSize.x], inPixels[x1 + y0 * inSize.x],
+            inPixels[x0 + y1 * inSize.x], inPixels[x1 + y1 * inSize.x]);
+    });
+}
+
+template <typename T>
+void resampleLevel(TNM067::Resampling::Method method, const LayerRAMPrecision<T>& inputImage,
+                   LayerRAMPrecision<T>& outputImage) {
+    const T* inPixels = inputImage.getDataTyped();
+    T* outPixels = outputImage.getDataTyped();
+
+    TNM067::Resampling::dispatch(method, [&](auto m) {
+        const TNM067::Resampling::Resampler<T, decltype(m)::value> resampler(
+            inputImage.getDimensions(), outputImage.getDimensions());
+        util::forEachPixelParallel(resampler.getTileCount(), [&](size2_t tile) {
+            resampler.resampleTile(inPixels, outPixels, tile);
+        });
+    });
+}
+
+}  // namespace detail
+
+const ProcessorInfo ImagePyramid::processorInfo_{
+    "org.inviwo.ImagePyramid",  // Class identifier
+    "Image Pyramid",            // Display name
+    "TNM067",                   // Category
+    CodeState::Experimental,    // Code state
+    Tags::CPU,                  // Tags
+};
+const ProcessorInfo ImagePyramid::getProcessorInfo() const { return processorInfo_; }
+
+ImagePyramid::ImagePyramid()
+    : Processor()
+    , inport_("inport", true)
+    , outport_("outport", true)
+    , interpolationMethod_("interpolationMethod", "Interpolation Method",
+                           {
+                               {"piecewiseconstant", "Piecewise Constant (Nearest Neighbor)",
+                                ImageUpsampler::IntepolationMethod::PiecewiseConstant},
+                               {"bilinear", "Bilinear",
+                                ImageUpsampler::IntepolationMethod::Bilinear},
+                               {"biquadratic", "Biquadratic",
+                                ImageUpsampler::IntepolationMethod::Biquadratic},
+                               {"barycentric", "Barycentric",
+                                ImageUpsampler::IntepolationMethod::Barycentric},
+                           },
+                           1)
+    , level_("level", "Source Level", 0, 0, 64) {
+
+    addPort(inport_);
+    addPort(outport_);
+    addProperty(interpolationMethod_);
+
+    level_.setReadOnly(true);
+    level_.setInvalidationLevel(InvalidationLevel::Valid);
+    level_.setSerializationMode(PropertySerializationMode::None);
+    addProperty(level_);
+}
+
+std::shared_ptr<const Image> ImagePyramid::getLevel(size_t l) {
+    if (levels_.empty()) levels_.push_back(inport_.getData());
+
+    while (levels_.size() <= l) {
+        const auto& prev = levels_.back();
+        auto next = std::make_shared<Image>(TNM067::Resampling::halfSize(prev->getDimensions()),
+                                            prev->getDataFormat());
+        next->getColorLayer()->setSwizzleMask(prev->getColorLayer()->getSwizzleMask());
+        auto outLayer = next->getColorLayer()->getEditableRepresentation<LayerRAM>();
+        outLayer->dispatch<void>([&](auto outRep) {
+            auto inRep = prev->getColorLayer()->getRepresentation<LayerRAM>();
+            detail::downsampleHalf(*(const decltype(outRep))(inRep), *outRep);
+        });
+        levels_.push_back(next);
+    }
+    return levels_[l];
+}
+
+void ImagePyramid::process() {
+    if (inport_.isChanged()) levels_.clear();
+
+    const size2_t outDim = outport_.getDimensions();
+
+    // Walk down to the smallest level that is still at least as large as the output
+    size_t l = 0;
+    size2_t levelDim = inport_.getData()->getDimensions();
+    while (true) {
+        const size2_t next = TNM067::Resampling::halfSize(levelDim);
+        if (next == levelDim || next.x < outDim.x || next.y < outDim.y) break;
+        levelDim = next;
+        ++l;
+    }
+    level_.set(l);
+
+    const auto source = getLevel(l);
+    if (source->getDimensions() == outDim) {
+        outport_.setData(source);
+        return;
+    }
+
+    auto outputImage = std::make_shared<Image>(outDim, source->getDataFormat());
+    outputImage->getColorLayer()->setSwizzleMask(source->getColorLayer()->getSwizzleMask());
+    auto outLayer = outputImage->getColorLayer()->getEditableRepresentation<LayerRAM>();
+    outLayer->dispatch<void>([&](auto outRep) {
+        auto inRep = source->getColorLayer()->getRepresentation<LayerRAM>();
+        detail::resampleLevel(interpolationMethod_.get(), *(const decltype(outRep))(inRep),
+                              *outRep);
+    });
+
+    outport_.setData(outputImage);
+}
+
+}  // namespace inviwo
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/ports/imageport.h>
+#include <modules/tnm067lab1/processors/imageupsampler.h>
+
+namespace inviwo {
+
+/**
+ * \class ImagePyramid
+ * \brief Resamples an image to the output size starting from a cached mip pyramid level
+ * Level l + 1 halves level l, see Resampling::halfSize, and averages 2x2 pixels with the rounded
+ * box filter Resampling::average4. Levels are built lazily, only as deep as the requested output
+ * size needs, and kept until the input changes. The output is resampled from the smallest level
+ * that is still at least as large as the output, so zooming out never re-filters the full
+ * resolution image.
+ */
+class IVW_MODULE_TNM067LAB1_API ImagePyramid : public Processor {
+public:
+    ImagePyramid();
+    virtual ~ImagePyramid() = default;
+
+    virtual void process() override;
+
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+private:
+    /**
+     * Returns level l of the pyramid, level 0 is the input image. Builds missing levels.
+     */
+    std::shared_ptr<const Image> getLevel(size_t l);
+
+    ImageInport inport_;
+    ImageOutport outport_;
+
+    TemplateOptionProperty<ImageUpsampler::IntepolationMethod> interpolationMethod_;
+    IntSizeTProperty level_;
+
+    std::vector<std::shared_ptr<const Image>> levels_;
+};
+
+}  // namespace inviwo
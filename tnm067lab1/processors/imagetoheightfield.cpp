@@ -1,7 +1,17 @@
 #include <modules/tnm067lab1/processors/imagetoheightfield.h>
 #include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <modules/tnm067lab1/utils/heightfieldwriter.h>
 #include <inviwo/core/util/imageramutils.h>
 #include <inviwo/core/datastructures/image/layerram.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+#include <inviwo/core/util/glmconvert.h>
+#include <inviwo/core/datastructures/buffer/buffer.h>
+#include <inviwo/core/util/fileextension.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 
 namespace inviwo {
 
@@ -19,7 +29,24 @@ ImageToHeightfield::ImageToHeightfield()
     : Processor()
     , imageInport_("imageInport", true)
     , meshOutport_("meshOutport")
+    , chunksOutport_("chunksOutport")
+    , instanceOutport_("instanceOutport")
+    , meshType_("meshType", "Mesh Type",
+                {{"boxes", "Boxes", MeshType::Boxes},
+                 {"culledColumns", "Culled Columns", MeshType::CulledColumns},
+                 {"terrain", "Terrain", MeshType::Terrain},
+                 {"quadtree", "Quadtree", MeshType::Quadtree},
+                 {"instancedBoxes", "Instanced Boxes", MeshType::InstancedBoxes}})
     , heightScaleFactor_("heightScaleFactor", "Height Scale Factor", 1.0f, 0.001f, 2.0f, 0.001f)
+    , mergeTolerance_("mergeTolerance", "Merge Tolerance", 0.0f, 0.0f, 1.0f, 0.001f)
+    , triangleBudget_("triangleBudget", "Triangle Budget", 2000000, 12, 200000000, 1000)
+    , chunked_("chunked", "Chunked Output", false)
+    , chunkSize_("chunkSize", "Chunk Size", 128, 8, 4096)
+    , fileOutput_("fileOutput", "Write to File")
+    , outputFile_("outputFile", "Output File")
+    , stripRows_("stripRows", "Strip Rows", 64, 1, 4096)
+    , writeFile_("writeFile", "Write File")
+    , cancelWrite_("cancelWrite", "Cancel")
     , numColors_("numColors", "Number of colors", 2, 1, 10)
     , colors_(
           {FloatVec4Property{"color1", "Color 1", util::ordinalColor(0.0f, 0.0f, 0.0f, 1.0f)},
@@ -31,11 +58,19 @@ ImageToHeightfield::ImageToHeightfield()
            FloatVec4Property{"color7", "Color 7", util::ordinalColor(1.0f, 1.0f, 1.0f, 1.0f)},
            FloatVec4Property{"color8", "Color 8", util::ordinalColor(1.0f, 1.0f, 1.0f, 1.0f)},
            FloatVec4Property{"color9", "Color 9", util::ordinalColor(1.0f, 1.0f, 1.0f, 1.0f)},
-           FloatVec4Property{"color10", "Color 10", util::ordinalColor(1.0f, 1.0f, 1.0f, 1.0f)}}) {
+           FloatVec4Property{"color10", "Color 10", util::ordinalColor(1.0f, 1.0f, 1.0f, 1.0f)}})
+    , writeJob_([this](float progress) { updateProgress(progress); }) {
 
     addPort(imageInport_);
     addPort(meshOutport_);
+    addPort(chunksOutport_);
+    addPort(instanceOutport_);
+    addProperty(meshType_);
     addProperty(heightScaleFactor_);
+    addProperty(mergeTolerance_);
+    addProperty(triangleBudget_);
+    addProperty(chunked_);
+    addProperty(chunkSize_);
 
     addProperty(numColors_);
     for (auto& c : colors_) {
@@ -50,96 +85,290 @@ ImageToHeightfield::ImageToHeightfield()
 
     numColors_.onChange(colorVisibility);
     colorVisibility();
+
+    outputFile_.setAcceptMode(AcceptMode::Save);
+    outputFile_.addNameFilter(FileExtension("ply", "Binary PLY mesh"));
+    fileOutput_.addProperty(outputFile_);
+    fileOutput_.addProperty(stripRows_);
+    fileOutput_.addProperty(writeFile_);
+    fileOutput_.addProperty(cancelWrite_);
+    writeFile_.onChange([this]() { writeFile(); });
+    cancelWrite_.onChange([this]() { writeJob_.cancel(); });
+    addProperty(fileOutput_);
+
+    auto lodVisibility = [&]() {
+        const bool quadtree = meshType_.get() == MeshType::Quadtree;
+        mergeTolerance_.setVisible(quadtree);
+        triangleBudget_.setVisible(quadtree);
+    };
+    meshType_.onChange(lodVisibility);
+    lodVisibility();
+
+    chunked_.onChange([&]() { chunkSize_.setVisible(chunked_); });
+    chunkSize_.setVisible(chunked_);
 }
 
 namespace {
-using HFMesh = TypedMesh<buffertraits::PositionsBuffer, buffertraits::NormalBuffer,
-                         buffertraits::ColorsBuffer>;
-
-void addFace(std::vector<HFMesh::Vertex>& vertices, std::vector<unsigned int>& indices,
-             const vec3& c1, const vec3& c2, const vec3& c3, const vec3& c4, const vec3& normal,
-             const vec4& color) {
 
-    unsigned int startID = static_cast<unsigned int>(vertices.size());
-    vertices.emplace_back(c1, normal, color);
-    vertices.emplace_back(c2, normal, color);
-    vertices.emplace_back(c3, normal, color);
-    vertices.emplace_back(c4, normal, color);
+// The first channel of every pixel of rows [first, first + count) in row order, read from the
+// typed buffer without going through the virtual LayerRAM::getAsDouble. The rows are converted in
+// parallel unless parallel is false, as in a task that already runs on the thread pool.
+std::vector<float> pixelRows(const LayerRAM& image, size_t first, size_t count,
+                             bool parallel = true) {
+    return image.dispatch<std::vector<float>>([&](const auto rep) {
+        const auto data = rep->getDataTyped() + first * rep->getDimensions().x;
+        const size_t width = rep->getDimensions().x;
+        std::vector<float> values(width * count);
+        auto convertRow = [&](size2_t row) {
+            const size_t offset = row.y * width;
+            for (size_t i = offset; i < offset + width; ++i) {
+                values[i] = static_cast<float>(util::glm_convert<double>(data[i]));
+            }
+        };
+        if (parallel) {
+            util::forEachPixelParallel(size2_t{1, count}, convertRow);
+        } else {
+            for (size_t y = 0; y < count; ++y) convertRow(size2_t{0, y});
+        }
+        return values;
+    });
+}
 
-    indices.insert(indices.end(),
-                   {startID + 0, startID + 1, startID + 2, startID + 0, startID + 2, startID + 3});
+std::vector<float> pixelValues(const LayerRAM& image) {
+    return pixelRows(image, 0, image.getDimensions().y);
 }
 
-std::shared_ptr<Mesh> buildMesh(const LayerRAM& image, const ScalarToColorMapping& map,
-                                float scaleFactor) {
-    const auto dims = image.getDimensions();
-
-    auto mesh = std::make_shared<HFMesh>();
-    auto& indices =
-        mesh->addIndexBuffer(DrawType::Triangles, ConnectivityType::None)->getDataContainer();
-
-    std::vector<HFMesh::Vertex> vertices;
-
-    const auto bufferSize = 24 * dims.x * dims.y;
-    indices.reserve(bufferSize);
-    vertices.reserve(bufferSize);
-
-    const vec2 cellSize = 1.0f / vec2(dims);
-    util::forEachPixel(image, [&](const size2_t& pos) {
-        const vec2 origin2D = vec2(pos) * cellSize;
-        const vec3 origin(origin2D.x, 0.0f, origin2D.y);
-
-        // TODO: sample image
-        const float imageValue = image.getAsDouble(pos);
-
-        const float height = imageValue * scaleFactor;
-
-        const vec4 color = map.sample(imageValue);
-
-        // Box Corners
-        const auto zero = origin + vec3(0.0f, 0.0f, 0.0f);
-        const auto px = origin + vec3(cellSize.x, 0.0f, 0.0f);
-        const auto pz = origin + vec3(0.0f, 0.0f, cellSize.y);
-        const auto py = origin + vec3(0.0f, height, 0.0f);
-        const auto pxpy = origin + vec3(cellSize.x, height, 0.0f);
-        const auto pxpz = origin + vec3(cellSize.x, 0.0f, cellSize.y);
-        const auto pypz = origin + vec3(0.0f, height, cellSize.y);
-        const auto pxpypz = origin + vec3(cellSize.x, height, cellSize.y);
-
-        // Box Normals
-        constexpr auto down = vec3(0.0f, -1.0f, 0.0f);
-        constexpr auto up = vec3(0.0f, 1.0f, 0.0f);
-        constexpr auto left = vec3(-1.0f, 0.0f, 0.0f);
-        constexpr auto right = vec3(1.0f, 0.0f, 0.0f);
-        constexpr auto front = vec3(0.0f, 0.0f, -1.0f);
-        constexpr auto back = vec3(0.0f, 0.0f, 1.0f);
-
-        addFace(vertices, indices, zero, px, pxpz, pz, down, color);       // Bottom face
-        addFace(vertices, indices, py, pxpy, pxpypz, pypz, up, color);     // Top face
-        addFace(vertices, indices, zero, pz, pypz, py, left, color);       // Left face
-        addFace(vertices, indices, px, pxpz, pxpypz, pxpy, right, color);  // Right face
-        addFace(vertices, indices, zero, px, pxpy, py, front, color);      // Front face
-        addFace(vertices, indices, pz, pxpz, pxpypz, pypz, back, color);   // Back face
-    });
+}  // namespace
 
-    mesh->addVertices(vertices);
+ImageToHeightfield::Part ImageToHeightfield::makePart(
+    TNM067::Heightfield::Geometry&& geometry) const {
+    Part part;
+    part.builtHeights.reserve(geometry.positions.size());
+    for (const auto& p : geometry.positions) part.builtHeights.push_back(p.y);
+    part.builtNormals = geometry.normals;
+    part.builtHeightScale = heightScaleFactor_;
+    part.positions = util::makeBuffer(std::move(geometry.positions));
+    part.normals = util::makeBuffer(std::move(geometry.normals));
+    part.colors = util::makeBuffer(std::move(geometry.colors));
+    part.values = std::move(geometry.values);
+    part.heightScale = heightScaleFactor_;
+    part.baseColors = map_.getBaseColors();
 
-    return mesh;
+    part.mesh = std::make_shared<Mesh>(DrawType::Triangles, ConnectivityType::None);
+    part.mesh->addBuffer(BufferType::PositionAttrib, part.positions);
+    part.mesh->addBuffer(BufferType::NormalAttrib, part.normals);
+    part.mesh->addBuffer(BufferType::ColorAttrib, part.colors);
+    part.mesh->addIndices(Mesh::MeshInfo(DrawType::Triangles, ConnectivityType::None),
+                          util::makeIndexBuffer(std::move(geometry.indices)));
+    return part;
 }
 
-}  // namespace
+std::vector<vec4> ImageToHeightfield::getBaseColors() const {
+    std::vector<vec4> baseColors;
+    for (size_t i = 0; i < numColors_.get(); i++) {
+        baseColors.push_back(colors_[i].get());
+    }
+    return baseColors;
+}
+
+ImageToHeightfield::MeshSettings ImageToHeightfield::getMeshSettings() const {
+    return {meshType_.get(), heightScaleFactor_.get(), mergeTolerance_.get(), triangleBudget_.get(),
+            map_};
+}
+
+TNM067::Heightfield::Geometry ImageToHeightfield::buildGeometry(
+    const MeshSettings& settings, const TNM067::Heightfield::Rows& image,
+    const TNM067::Region& region, bool parallel) {
+    namespace hf = TNM067::Heightfield;
+    switch (settings.type) {
+        case MeshType::Boxes:
+        case MeshType::InstancedBoxes:
+            return hf::boxes(image, settings.heightScale, settings.map, region, parallel);
+        case MeshType::CulledColumns:
+            return hf::culledColumns(image, settings.heightScale, settings.map, region);
+        case MeshType::Terrain:
+            return hf::terrain(image, settings.heightScale, settings.map, region, parallel);
+        case MeshType::Quadtree: {
+            // Every chunk or strip gets the part of the budget of its share of the pixels
+            const double share = static_cast<double>(region.size.x * region.size.y) /
+                                 (image.dims.x * image.dims.y);
+            const auto budget = static_cast<size_t>(share * settings.triangleBudget);
+            return hf::quadtree(image, settings.heightScale, settings.map, settings.mergeTolerance,
+                                budget, region, parallel);
+        }
+    }
+    return {};
+}
 
 void ImageToHeightfield::process() {
-    const auto layer = imageInport_.getData()->getColorLayer()->getRepresentation<LayerRAM>();
+    const auto baseColors = getBaseColors();
+    map_.setBaseColors(baseColors);
 
-    ScalarToColorMapping map;
-    for (size_t i = 0; i < numColors_.get(); i++) {
-        map.addBaseColors(colors_[i].get());
+    if (meshType_.get() == MeshType::InstancedBoxes) {
+        processInstanced();
+        return;
+    }
+    instanceOutport_.clear();
+    instanceValues_.clear();
+
+    // Only a new image or these settings need new meshes, the height scale and the colors are
+    // patched into the meshes that are already there
+    const bool settingsChanged = meshType_.isModified() || mergeTolerance_.isModified() ||
+                                 triangleBudget_.isModified() || chunked_.isModified() ||
+                                 chunkSize_.isModified();
+    if (imageInport_.isChanged() || settingsChanged || parts_.empty()) {
+        const auto layer = imageInport_.getData()->getColorLayer()->getRepresentation<LayerRAM>();
+        const auto values = pixelValues(*layer);
+        const auto dims = layer->getDimensions();
+        const auto settings = getMeshSettings();
+        auto build = [&](const TNM067::Region& region) {
+            return buildGeometry(settings, TNM067::Heightfield::Rows{values.data(), dims}, region);
+        };
+
+        if (chunked_) {
+            // A changed setting affects every chunk, a new image only the chunks whose pixels
+            // changed
+            const auto changed = chunks_.update(values.data(), dims, chunkSize_, settingsChanged);
+            parts_.resize(chunks_.regions().size());
+            for (const auto i : changed) {
+                parts_[i] = makePart(build(chunks_.regions()[i]));
+            }
+        } else {
+            chunks_.clear();
+            parts_.clear();
+            parts_.push_back(makePart(build(TNM067::Region{size2_t(0), dims})));
+        }
     }
 
-    const auto mesh = buildMesh(*layer, map, heightScaleFactor_);
+    for (auto& part : parts_) {
+        if (part.heightScale != heightScaleFactor_) {
+            TNM067::Heightfield::rescaleHeights(
+                part.builtHeights, part.builtNormals, heightScaleFactor_ / part.builtHeightScale,
+                part.positions->getEditableRAMRepresentation()->getDataContainer(),
+                part.normals->getEditableRAMRepresentation()->getDataContainer());
+            part.heightScale = heightScaleFactor_;
+        }
+        if (part.baseColors != baseColors) {
+            TNM067::Heightfield::recolor(
+                part.values, map_, part.colors->getEditableRAMRepresentation()->getDataContainer());
+            part.baseColors = baseColors;
+        }
+    }
+
+    auto meshes = std::make_shared<std::vector<std::shared_ptr<Mesh>>>();
+    for (const auto& part : parts_) meshes->push_back(part.mesh);
+    if (chunked_) {
+        meshOutport_.clear();
+    } else {
+        meshOutport_.setData(parts_.front().mesh);
+    }
+    chunksOutport_.setData(meshes);
+}
 
-    meshOutport_.setData(mesh);
+void ImageToHeightfield::processInstanced() {
+    parts_.clear();
+    chunks_.clear();
+
+    // The instances are rebuilt from the kept values for every change, they are small enough
+    // that patching them would not be faster
+    if (imageInport_.isChanged() || meshType_.isModified() || instanceValues_.empty()) {
+        const auto layer = imageInport_.getData()->getColorLayer()->getRepresentation<LayerRAM>();
+        const auto dims = layer->getDimensions();
+        if (dims.x > 65536 || dims.y > 65536) {
+            LogError("Instanced boxes support images of at most 65536 by 65536 pixels, got "
+                     << dims);
+            return;
+        }
+        instanceValues_ = pixelValues(*layer);
+        instanceDims_ = dims;
+    }
+
+    auto box = makePart(TNM067::Heightfield::unitBox()).mesh;
+    mat4 model(1.0f);
+    model[0][0] = 1.0f / instanceDims_.x;
+    model[2][2] = 1.0f / instanceDims_.y;
+    box->setModelMatrix(model);
+
+    meshOutport_.setData(box);
+    chunksOutport_.setData(std::make_shared<std::vector<std::shared_ptr<Mesh>>>(1, box));
+    instanceOutport_.setData(util::makeBuffer(TNM067::Heightfield::instances(
+        instanceValues_.data(), instanceDims_, heightScaleFactor_, map_)));
+}
+
+void ImageToHeightfield::writeFile() {
+    const std::string path = outputFile_.get();
+    if (path.empty()) {
+        LogError("Choose an output file");
+        return;
+    }
+    if (!imageInport_.hasData()) {
+        LogError("No input image to write");
+        return;
+    }
+    if (writeJob_.running()) {
+        LogWarn("Already writing a file, cancel it first");
+        return;
+    }
+    map_.setBaseColors(getBaseColors());
+
+    // The image and the settings are taken here on the main thread, the job only reads its copies
+    auto image = imageInport_.getData();
+    const auto layer = image->getColorLayer()->getRepresentation<LayerRAM>();
+    const auto settings = getMeshSettings();
+    const size_t stripRows = stripRows_;
+
+    writeJob_.start([image, layer, settings, stripRows, path](
+                        const TNM067::BackgroundJob::Progress& progress) {
+        const auto dims = layer->getDimensions();
+        // The faces are kept in a scratch file next to the output until all vertices are written
+        const std::string facesPath = path + ".faces";
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        std::fstream faces(facesPath,
+                           std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+        if (!out || !faces) {
+            LogErrorCustom("ImageToHeightfield", "Could not open " << path << " for writing");
+            progress.report(0.0f);
+            return;
+        }
+
+        // Each strip converts just its own rows, and the ones around it that its builder reads.
+        // The job already runs on the thread pool, so a strip is built on this thread only,
+        // waiting on tasks queued behind it on the same pool could deadlock.
+        auto buildStrip = [&](const TNM067::Region& strip) {
+            const size_t first = strip.offset.y > 0 ? strip.offset.y - 1 : 0;
+            const size_t last = std::min(dims.y, strip.offset.y + strip.size.y + 2);
+            const auto values = pixelRows(*layer, first, last - first, false);
+            return buildGeometry(settings, TNM067::Heightfield::Rows{values.data(), dims, first},
+                                 strip, false);
+        };
+        const auto stats = TNM067::Heightfield::writePly(
+            out, faces, dims, stripRows, buildStrip,
+            [&](float done) { return progress.report(done); });
+        const bool failed = !out || !faces;
+        out.close();
+        faces.close();
+        std::remove(facesPath.c_str());
+
+        if (stats.tooManyVertices || stats.cancelled || failed) {
+            std::remove(path.c_str());
+            progress.report(0.0f);
+        }
+        if (stats.tooManyVertices) {
+            LogErrorCustom("ImageToHeightfield",
+                           "Could not write " << path << ", the heightfield needs more than 2^32 "
+                                              << "vertices, which PLY indices can not address");
+        } else if (stats.cancelled) {
+            LogInfoCustom("ImageToHeightfield", "Cancelled writing " << path);
+        } else if (failed) {
+            LogErrorCustom("ImageToHeightfield", "Could not write " << path);
+        } else {
+            LogInfoCustom("ImageToHeightfield",
+                          "Wrote " << stats.vertices << " vertices and " << stats.triangles
+                                   << " triangles to " << path << ", at most "
+                                   << stats.peakStripVertices
+                                   << " vertices were held in memory at once");
+        }
+    });
 }
 
 }  // namespace inviwo
@@ -2,17 +2,61 @@
 
 #include <modules/tnm067lab1/tnm067lab1moduledefine.h>
 #include <inviwo/core/processors/processor.h>
+#include <inviwo/core/processors/progressbarowner.h>
 #include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/properties/boolproperty.h>
+#include <inviwo/core/properties/buttonproperty.h>
+#include <inviwo/core/properties/compositeproperty.h>
+#include <inviwo/core/properties/fileproperty.h>
 #include <inviwo/core/ports/imageport.h>
 #include <inviwo/core/ports/meshport.h>
+#include <inviwo/core/ports/bufferport.h>
 #include <modules/base/properties/gaussianproperty.h>
 #include <modules/tnm067lab1/utils/scalartocolormapping.h>
-#include <inviwo/core/datastructures/geometry/basicmesh.h>
+#include <modules/tnm067lab1/utils/heightfieldchunks.h>
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <modules/tnm067lab1/utils/backgroundjob.h>
+#include <inviwo/core/datastructures/geometry/mesh.h>
+#include <inviwo/core/datastructures/buffer/buffer.h>
 
 namespace inviwo {
 
-class IVW_MODULE_TNM067LAB1_API ImageToHeightfield : public Processor {
+/**
+ * \class ImageToHeightfield
+ * \brief Builds a mesh of one column per pixel, as high as the pixel value
+ * Boxes emits a closed box of 24 vertices per pixel, see TNM067::Heightfield::boxes. Culled
+ * Columns skips all faces that can not be seen and shares vertices between faces with the same
+ * normal, see TNM067::Heightfield::culledColumns. Terrain is a continuous surface with one vertex
+ * per pixel instead of columns, see TNM067::Heightfield::terrain. Quadtree merges blocks of pixels
+ * whose values differ by at most the merge tolerance into single boxes and stays within the
+ * triangle budget, see TNM067::Heightfield::quadtree.
+ *
+ * Instanced Boxes is the Boxes heightfield for instanced rendering. The mesh outport has a single
+ * unit box, TNM067::Heightfield::unitBox, whose model matrix scales pixels to the unit square,
+ * and the instance outport one packed 12 byte TNM067::Heightfield::Instance per pixel that places
+ * and scales it. It is never chunked.
+ *
+ * Write File streams the heightfield of the current settings to a binary PLY file in strips of
+ * Strip Rows rows, so that only the mesh and the pixel values of one strip are in memory at a time,
+ * see TNM067::Heightfield::writePly. Instanced Boxes are written as Boxes. The file is written in
+ * the background with its progress on the progress bar and can be stopped with Cancel, a
+ * cancelled or failed file is removed.
+ *
+ * With Chunked Output the heightfield is split into meshes of Chunk Size by Chunk Size pixels,
+ * each with its own buffers, on the chunks outport. When only the image changed just the chunks
+ * whose pixels changed are rebuilt, the others are passed on as they are. The mesh outport is
+ * empty then. Without it the mesh outport has the whole heightfield, which is also the only mesh
+ * on the chunks outport.
+ *
+ * The meshes are kept between frames. Changing only the height scale or the colors patches their
+ * buffers in place, see TNM067::Heightfield::rescaleHeights and TNM067::Heightfield::recolor,
+ * instead of building them again.
+ */
+class IVW_MODULE_TNM067LAB1_API ImageToHeightfield : public Processor, public ProgressBarOwner {
 public:
+    enum class MeshType { Boxes, CulledColumns, Terrain, Quadtree, InstancedBoxes };
+
     ImageToHeightfield();
     virtual ~ImageToHeightfield() = default;
 
@@ -22,13 +66,66 @@ public:
     static const ProcessorInfo processorInfo_;
 
 private:
+    // One output mesh, with the buffers and settings needed to update it in place
+    struct Part {
+        std::shared_ptr<Mesh> mesh;
+        std::shared_ptr<Buffer<vec3>> positions;
+        std::shared_ptr<Buffer<vec3>> normals;
+        std::shared_ptr<Buffer<vec4>> colors;
+        std::vector<float> values;  // see TNM067::Heightfield::Geometry::values
+        // The y coordinates and normals as built with builtHeightScale, every new height scale is
+        // applied to these rather than to the current buffers, see rescaleHeights()
+        std::vector<float> builtHeights;
+        std::vector<vec3> builtNormals;
+        float builtHeightScale;
+        float heightScale;
+        std::vector<vec4> baseColors;
+    };
+    // The settings buildGeometry() needs, copied so that a file can be written in the background
+    struct MeshSettings {
+        MeshType type;
+        float heightScale;
+        float mergeTolerance;
+        size_t triangleBudget;
+        ScalarToColorMapping map;
+    };
+    Part makePart(TNM067::Heightfield::Geometry&& geometry) const;
+    std::vector<vec4> getBaseColors() const;
+    MeshSettings getMeshSettings() const;
+    static TNM067::Heightfield::Geometry buildGeometry(const MeshSettings& settings,
+                                                       const TNM067::Heightfield::Rows& image,
+                                                       const TNM067::Region& region,
+                                                       bool parallel = true);
+    void processInstanced();
+    void writeFile();
+
     ImageInport imageInport_;
     MeshOutport meshOutport_;
+    DataOutport<std::vector<std::shared_ptr<Mesh>>> chunksOutport_;
+    BufferOutport instanceOutport_;
+    TemplateOptionProperty<MeshType> meshType_;
     FloatProperty heightScaleFactor_;
+    FloatProperty mergeTolerance_;
+    IntSizeTProperty triangleBudget_;
+    BoolProperty chunked_;
+    IntSizeTProperty chunkSize_;
 
     IntSizeTProperty numColors_;
     std::array<FloatVec4Property, 10> colors_;
 
+    CompositeProperty fileOutput_;
+    FileProperty outputFile_;
+    IntSizeTProperty stripRows_;
+    ButtonProperty writeFile_;
+    ButtonProperty cancelWrite_;
+
+    // Kept between frames, its lookup table only changes with the colors
+    ScalarToColorMapping map_;
+    TNM067::HeightfieldChunks chunks_;
+    std::vector<Part> parts_;  // the whole heightfield, or one per chunk of chunks_
+    std::vector<float> instanceValues_;  // the image of the instanced boxes
+    size2_t instanceDims_{0};
+    TNM067::BackgroundJob writeJob_;  // last, so that a running write is stopped first
 };
 
 }  // namespace inviwo
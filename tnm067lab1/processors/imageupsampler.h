@@ -5,13 +5,14 @@
 #include <inviwo/core/properties/ordinalproperty.h>
 #include <inviwo/core/ports/imageport.h>
 #include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <modules/tnm067lab1/utils/resampling.h>
 #include <inviwo/core/properties/optionproperty.h>
 
 namespace inviwo {
 
 class IVW_MODULE_TNM067LAB1_API ImageUpsampler : public Processor {
 public:
-    enum class IntepolationMethod { PiecewiseConstant, Bilinear, Biquadratic, Barycentric };
+    using IntepolationMethod = TNM067::Resampling::Method;
 
     ImageUpsampler();
     virtual ~ImageUpsampler() = default;
@@ -29,6 +30,8 @@ private:
 
     // Interpolation method
     TemplateOptionProperty<IntepolationMethod> interpolationMethod_;
+
+    std::shared_ptr<Image> outputImage_;  // reallocated only when the size or format changes
 };
 
 }  // namespace inviwo
@@ -0,0 +1,197 @@
+#include <modules/tnm067lab1/processors/streamingimageupsampler.h>
+#include <modules/tnm067lab1/utils/datheader.h>
+#include <inviwo/core/datastructures/image/layerram.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+#include <inviwo/core/util/fileextension.h>
+#include <inviwo/core/util/filesystem.h>
+#include <inviwo/core/util/formats.h>
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace inviwo {
+
+namespace detail {
+
+// Upsamples to out. Rows are read from pixels, the whole input image, or if rawInput is set from
+// rawInput one row at a time, then pixels is only used for its type. Returns false if writing
+// stopped early, because progress was cancelled or one of the streams failed.
+template <typename T>
+bool upsampleToStream(TNM067::Resampling::Method method, const T* pixels, std::istream* rawInput,
+                      size2_t inputSize, size2_t outputSize, size_t stripHeight, std::ostream& out,
+                      const TNM067::BackgroundJob::Progress& progress) {
+    const size_t rowBytes = inputSize.x * sizeof(T);
+    std::vector<T> row(rawInput ? inputSize.x : 0);
+    auto source = [&](size_t y) -> const T* {
+        if (!rawInput) return pixels + y * inputSize.x;
+        // Rows are requested in increasing order but may skip some when downsampling
+        rawInput->seekg(static_cast<std::streamoff>(y * rowBytes));
+        rawInput->read(reinterpret_cast<char*>(row.data()), rowBytes);
+        return row.data();
+    };
+    auto sink = [&](const T* strip, size_t firstRow, size_t rowCount) {
+        out.write(reinterpret_cast<const char*>(strip), rowCount * outputSize.x * sizeof(T));
+        if (!out || (rawInput && !*rawInput)) return false;
+        return progress.report(static_cast<float>(firstRow + rowCount) / outputSize.y);
+    };
+
+    return TNM067::Resampling::dispatch(method, [&](auto m) {
+        return TNM067::Resampling::StripResampler<T, decltype(m)::value>(inputSize, outputSize,
+                                                                         stripHeight)
+            .run(source, sink);
+    });
+}
+
+}  // namespace detail
+
+const ProcessorInfo StreamingImageUpsampler::processorInfo_{
+    "org.inviwo.StreamingImageUpsampler",  // Class identifier
+    "Streaming Image Upsampler",           // Display name
+    "TNM067",                              // Category
+    CodeState::Experimental,               // Code state
+    Tags::CPU,                             // Tags
+};
+const ProcessorInfo StreamingImageUpsampler::getProcessorInfo() const { return processorInfo_; }
+
+StreamingImageUpsampler::StreamingImageUpsampler()
+    : Processor()
+    , ProgressBarOwner()
+    , inport_("inport", true)
+    , interpolationMethod_("interpolationMethod", "Interpolation Method",
+                           {
+                               {"piecewiseconstant", "Piecewise Constant (Nearest Neighbor)",
+                                TNM067::Resampling::Method::PiecewiseConstant},
+                               {"bilinear", "Bilinear", TNM067::Resampling::Method::Bilinear},
+                               {"biquadratic", "Biquadratic",
+                                TNM067::Resampling::Method::Biquadratic},
+                               {"barycentric", "Barycentric",
+                                TNM067::Resampling::Method::Barycentric},
+                           })
+    , outputSize_("outputSize", "Output Size", size2_t(16384), size2_t(1), size2_t(1 << 20))
+    , stripHeight_("stripHeight", "Strip Height", 64, 1, 4096)
+    , inputFile_("inputFile", "Input File (dat, optional)", "", "image")
+    , file_("file", "Output File (raw)", "", "image")
+    , write_("write", "Write")
+    , cancel_("cancel", "Cancel")
+    , writeJob_([this](float progress) { updateProgress(progress); }) {
+
+    inport_.setOptional(true);
+    addPort(inport_);
+
+    addProperty(interpolationMethod_);
+    addProperty(outputSize_);
+    addProperty(stripHeight_);
+    inputFile_.addNameFilter(FileExtension("dat", "Raw image header"));
+    addProperty(inputFile_);
+    file_.setAcceptMode(AcceptMode::Save);
+    file_.addNameFilter(FileExtension("raw", "Raw image"));
+    addProperty(file_);
+    addProperty(write_);
+    addProperty(cancel_);
+    write_.onChange([this]() { write(); });
+    cancel_.onChange([this]() { writeJob_.cancel(); });
+}
+
+void StreamingImageUpsampler::process() {
+    // Nothing to do for a new input, files are only written by Write
+}
+
+void StreamingImageUpsampler::write() {
+    const std::string path = file_.get();
+    if (path.empty()) {
+        LogError("Choose an output file");
+        return;
+    }
+    const std::string datPath = filesystem::getFileDirectory(path) + "/" +
+                                filesystem::getFileNameWithoutExtension(path) + ".dat";
+    if (datPath == path) {
+        LogError("Choose an output file other than its .dat header");
+        return;
+    }
+    if (writeJob_.running()) {
+        LogWarn("Already writing a file, cancel it first");
+        return;
+    }
+
+    // The rows come from the raw file of the input header if one is chosen, otherwise from the
+    // input image, whose representation is taken here on the main thread
+    std::shared_ptr<const Image> image;
+    std::shared_ptr<const LayerRAM> inLayer;
+    std::string rawInput;
+    size2_t inputSize;
+    std::string format;
+    if (!inputFile_.get().empty()) {
+        std::ifstream datFile(inputFile_.get());
+        const auto header = TNM067::readDatHeader(datFile);
+        const auto dataFormat = header ? DataFormatBase::get(header->format) : nullptr;
+        if (!dataFormat) {
+            LogError("Could not read the raw image header " << inputFile_.get());
+            return;
+        }
+        rawInput = filesystem::getFileDirectory(inputFile_.get()) + "/" + header->rawFile;
+        inputSize = header->dims;
+        format = header->format;
+        // A single pixel of the format, only used to dispatch on its type
+        inLayer = createLayerRAM(size2_t(1), LayerType::Color, dataFormat);
+    } else if (inport_.hasData()) {
+        image = inport_.getData();
+        inLayer = std::shared_ptr<const LayerRAM>(
+            image, image->getColorLayer()->getRepresentation<LayerRAM>());
+        inputSize = inLayer->getDimensions();
+        format = inLayer->getDataFormat()->getString();
+    } else {
+        LogError("Connect an input image or choose an input file");
+        return;
+    }
+
+    const auto method = interpolationMethod_.get();
+    const size2_t outputSize = outputSize_.get();
+    const size_t stripHeight = stripHeight_.get();
+
+    writeJob_.start([inLayer, rawInput, inputSize, format, method, outputSize, stripHeight, path,
+                     datPath](const TNM067::BackgroundJob::Progress& progress) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        std::ifstream in;
+        if (!rawInput.empty()) in.open(rawInput, std::ios::binary);
+        if (!out || (!rawInput.empty() && !in)) {
+            LogErrorCustom("StreamingImageUpsampler",
+                           "Could not open " << (out ? rawInput : path));
+            progress.report(0.0f);
+            return;
+        }
+
+        const bool completed = inLayer->dispatch<bool>([&](const auto inRep) {
+            return detail::upsampleToStream(method, inRep->getDataTyped(),
+                                            rawInput.empty() ? nullptr : &in, inputSize,
+                                            outputSize, stripHeight, out, progress);
+        });
+        out.close();
+
+        if (!completed || !out) {
+            std::remove(path.c_str());
+            progress.report(0.0f);
+            if (progress.cancelled()) {
+                LogInfoCustom("StreamingImageUpsampler", "Cancelled writing " << path);
+            } else if (in.is_open() && !in) {
+                LogErrorCustom("StreamingImageUpsampler", "Could not read " << rawInput);
+            } else {
+                LogErrorCustom("StreamingImageUpsampler", "Could not write " << path);
+            }
+            return;
+        }
+
+        std::ofstream dat(datPath);
+        const auto rawFile = filesystem::getFileNameWithExtension(path);
+        TNM067::writeDatHeader(dat, {rawFile, outputSize, format});
+        if (!dat) {
+            LogErrorCustom("StreamingImageUpsampler", "Could not write " << datPath);
+            return;
+        }
+        LogInfoCustom("StreamingImageUpsampler", "Wrote " << outputSize.x << "x" << outputSize.y
+                                                          << " " << format << " image to " << path
+                                                          << ", described by " << datPath);
+    });
+}
+
+}  // namespace inviwo
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/processors/progressbarowner.h>
+#include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/properties/fileproperty.h>
+#include <inviwo/core/properties/buttonproperty.h>
+#include <inviwo/core/ports/imageport.h>
+#include <modules/tnm067lab1/utils/resampling.h>
+#include <modules/tnm067lab1/utils/backgroundjob.h>
+
+namespace inviwo {
+
+/**
+ * \class StreamingImageUpsampler
+ * \brief Upsamples an image to a file without holding the output in memory
+ * The output is computed in horizontal strips and appended to a raw file, row by row with the
+ * same data format as the input. Peak memory is bounded by the strip height, which makes outputs
+ * far larger than the available RAM possible. Next to the raw file a .dat header records its
+ * size and format, which the volume readers of inviwo can open as a volume of one slice.
+ * The source rows come from the input image or, if an input file is chosen, from a raw file
+ * described by such a header, read one row at a time, e.g. the output of an earlier pass.
+ * Write runs in the background with its progress on the progress bar and can be stopped with
+ * Cancel, which removes the incomplete file.
+ */
+class IVW_MODULE_TNM067LAB1_API StreamingImageUpsampler : public Processor,
+                                                          public ProgressBarOwner {
+public:
+    StreamingImageUpsampler();
+    virtual ~StreamingImageUpsampler() = default;
+
+    virtual void process() override;
+
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+private:
+    void write();
+
+    ImageInport inport_;
+
+    TemplateOptionProperty<TNM067::Resampling::Method> interpolationMethod_;
+    IntSize2Property outputSize_;
+    IntSizeTProperty stripHeight_;
+    FileProperty inputFile_;
+    FileProperty file_;
+    ButtonProperty write_;
+    ButtonProperty cancel_;
+
+    TNM067::BackgroundJob writeJob_;  // last, so that a running write is stopped first
+};
+
+}  // namespace inviwo
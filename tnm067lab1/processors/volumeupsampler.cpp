@@ -0,0 +1,74 @@
+#include <modules/tnm067lab1/processors/volumeupsampler.h>
+#include <inviwo/core/datastructures/volume/volume.h>
+#include <inviwo/core/datastructures/volume/volumeram.h>
+#include <inviwo/core/datastructures/volume/volumeramprecision.h>
+#include <inviwo/core/util/volumeramutils.h>
+
+#include <type_traits>
+
+namespace inviwo {
+
+const ProcessorInfo VolumeUpsampler::processorInfo_{
+    "org.inviwo.VolumeUpsampler",  // Class identifier
+    "Volume Upsampler",            // Display name
+    "TNM067",                      // Category
+    CodeState::Experimental,       // Code state
+    Tags::CPU,                     // Tags
+};
+const ProcessorInfo VolumeUpsampler::getProcessorInfo() const { return processorInfo_; }
+
+VolumeUpsampler::VolumeUpsampler()
+    : Processor()
+    , inport_("inport")
+    , outport_("outport")
+    , interpolationMethod_("interpolationMethod", "Interpolation Method",
+                           {
+                               {"piecewiseconstant", "Piecewise Constant (Nearest Neighbor)",
+                                InterpolationMethod::PiecewiseConstant},
+                               {"trilinear", "Trilinear", InterpolationMethod::Trilinear},
+                               {"triquadratic", "Triquadratic", InterpolationMethod::Triquadratic},
+                           },
+                           1)
+    , outputSize_("outputSize", "Output Size", size3_t(128), size3_t(1), size3_t(1024))
+    , brickSize_("brickSize", "Brick Size", TNM067::Resampling::defaultBrickSize, 4, 256) {
+
+    addPort(inport_);
+    addPort(outport_);
+    addProperty(interpolationMethod_);
+    addProperty(outputSize_);
+    addProperty(brickSize_);
+}
+
+TNM067::Resampling::Method VolumeUpsampler::axisMethod(InterpolationMethod method) {
+    switch (method) {
+        case InterpolationMethod::PiecewiseConstant:
+            return TNM067::Resampling::Method::PiecewiseConstant;
+        case InterpolationMethod::Triquadratic:
+            return TNM067::Resampling::Method::Biquadratic;
+        case InterpolationMethod::Trilinear:
+        default:
+            return TNM067::Resampling::Method::Bilinear;
+    }
+}
+
+void VolumeUpsampler::process() {
+    auto inputVolume = inport_.getData();
+
+    auto outputVolume = std::make_shared<Volume>(outputSize_.get(), inputVolume->getDataFormat());
+    outputVolume->setModelMatrix(inputVolume->getModelMatrix());
+    outputVolume->setWorldMatrix(inputVolume->getWorldMatrix());
+    outputVolume->dataMap_ = inputVolume->dataMap_;
+
+    outputVolume->getEditableRepresentation<VolumeRAM>()->dispatch<void, dispatching::filter::All>(
+        [&](auto outRep) {
+            using Rep = std::remove_pointer_t<decltype(outRep)>;
+            auto inRep = static_cast<const Rep*>(inputVolume->getRepresentation<VolumeRAM>());
+            upsample(interpolationMethod_.get(), inRep->getDataTyped(), inRep->getDimensions(),
+                     outRep->getDataTyped(), outRep->getDimensions(), size3_t(brickSize_.get()),
+                     [](size3_t count, auto f) { util::forEachVoxelParallel(count, f); });
+        });
+
+    outport_.setData(outputVolume);
+}
+
+}  // namespace inviwo
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/ports/volumeport.h>
+#include <modules/tnm067lab1/utils/resampling.h>
+
+namespace inviwo {
+
+/**
+ * \class VolumeUpsampler
+ * \brief Resamples a volume to an arbitrary size using trilinear or triquadratic interpolation
+ * The output is split into bricks of Brick Size voxels that are resampled in parallel, see
+ * TNM067::Resampling::VolumeResampler. The model and world matrices and the data mapping of the
+ * input are kept, so the output covers the same space as the input.
+ */
+class IVW_MODULE_TNM067LAB1_API VolumeUpsampler : public Processor {
+public:
+    enum class InterpolationMethod { PiecewiseConstant, Trilinear, Triquadratic };
+
+    VolumeUpsampler();
+    virtual ~VolumeUpsampler() = default;
+
+    virtual void process() override;
+
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+    /**
+     * The method along each axis of the separable TNM067::Resampling::VolumeResampler
+     */
+    static TNM067::Resampling::Method axisMethod(InterpolationMethod method);
+
+    /**
+     * Resamples the volume src of size srcSize into dst of size dstSize in bricks of brickSize
+     * voxels. forEachBrick(count, f) calls f(brick) for every brick index in [0, count), in any
+     * order and on any thread.
+     */
+    template <typename T, typename ForEachBrick>
+    static void upsample(InterpolationMethod method, const T* src, size3_t srcSize, T* dst,
+                         size3_t dstSize, size3_t brickSize, ForEachBrick&& forEachBrick);
+
+private:
+    VolumeInport inport_;
+    VolumeOutport outport_;
+
+    TemplateOptionProperty<InterpolationMethod> interpolationMethod_;
+    IntSize3Property outputSize_;
+    IntSizeTProperty brickSize_;
+};
+
+template <typename T, typename ForEachBrick>
+void VolumeUpsampler::upsample(InterpolationMethod method, const T* src, size3_t srcSize, T* dst,
+                               size3_t dstSize, size3_t brickSize, ForEachBrick&& forEachBrick) {
+    TNM067::Resampling::dispatch(axisMethod(method), [&](auto m) {
+        if constexpr (decltype(m)::value != TNM067::Resampling::Method::Barycentric) {
+            const TNM067::Resampling::VolumeResampler<T, decltype(m)::value> resampler(
+                srcSize, dstSize, brickSize);
+            forEachBrick(resampler.getBrickCount(), [&](const size3_t& brick) {
+                resampler.resampleBrick(src, dst, brick);
+            });
+        }
+    });
+}
+
+}  // namespace inviwo
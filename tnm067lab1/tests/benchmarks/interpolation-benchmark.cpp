@@ -0,0 +1,146 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <benchmark/benchmark.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/interpolationmethods.h>
+
+#include <array>
+#include <random>
+#include <vector>
+
+namespace inviwo {
+
+namespace ip = TNM067::Interpolation;
+
+namespace {
+
+/**
+ * Adapters giving every interpolation template the same signature, eval(corners, x, y), so the
+ * benchmarks below can be written once. N is the number of corner values the method reads.
+ */
+struct Linear {
+    static constexpr size_t N = 2;
+    template <typename T, typename F>
+    static T eval(const std::array<T, N>& v, F x, F) {
+        return ip::linear(v[0], v[1], x);
+    }
+};
+
+struct Bilinear {
+    static constexpr size_t N = 4;
+    template <typename T, typename F>
+    static T eval(const std::array<T, N>& v, F x, F y) {
+        return ip::bilinear(v, x, y);
+    }
+};
+
+struct Quadratic {
+    static constexpr size_t N = 3;
+    template <typename T, typename F>
+    static T eval(const std::array<T, N>& v, F x, F) {
+        return ip::quadratic(v[0], v[1], v[2], x);
+    }
+};
+
+struct BiQuadratic {
+    static constexpr size_t N = 9;
+    template <typename T, typename F>
+    static T eval(const std::array<T, N>& v, F x, F y) {
+        return ip::biQuadratic(v, x, y);
+    }
+};
+
+struct Barycentric {
+    static constexpr size_t N = 4;
+    template <typename T, typename F>
+    static T eval(const std::array<T, N>& v, F x, F y) {
+        return ip::barycentric(v, x, y);
+    }
+};
+
+// Samples per iteration of the array benchmarks, sized so the largest case still fits in L2
+constexpr size_t minSamples = 1 << 8;
+constexpr size_t maxSamples = 1 << 14;
+
+/**
+ * Random corner values and sample positions in [0,1). The generator is seeded so that every
+ * run, and every method, sees the same data.
+ */
+template <typename Kernel, typename T>
+struct Samples {
+    using F = typename float_type<T>::type;
+
+    explicit Samples(size_t count) : corners(count), x(count), y(count) {
+        std::mt19937 rand(count);
+        std::uniform_real_distribution<F> dist(F(0), F(1));
+        for (size_t i = 0; i < count; ++i) {
+            for (auto& v : corners[i]) v = T(dist(rand));
+            x[i] = dist(rand);
+            y[i] = dist(rand);
+        }
+    }
+
+    std::vector<std::array<T, Kernel::N>> corners;
+    std::vector<F> x;
+    std::vector<F> y;
+};
+
+// One call per iteration, measures latency of a single evaluation
+template <typename Kernel, typename T>
+void BM_Scalar(benchmark::State& state) {
+    using F = typename float_type<T>::type;
+    Samples<Kernel, T> samples(1);
+    auto& v = samples.corners[0];
+    F x = samples.x[0];
+    F y = samples.y[0];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(x);
+        benchmark::DoNotOptimize(y);
+        auto res = Kernel::eval(v, x, y);
+        benchmark::DoNotOptimize(res);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// A loop over an array of independent samples, measures throughput
+template <typename Kernel, typename T>
+void BM_Array(benchmark::State& state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    Samples<Kernel, T> samples(count);
+    std::vector<T> out(count);
+    for (auto _ : state) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = Kernel::eval(samples.corners[i], samples.x[i], samples.y[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetBytesProcessed(state.iterations() * count * (sizeof(std::array<T, Kernel::N>) + sizeof(T)));
+}
+
+}  // namespace
+
+#define TNM067_INTERPOLATION_BENCHMARK(Kernel, T)            \
+    BENCHMARK_TEMPLATE(BM_Scalar, Kernel, T);                \
+    BENCHMARK_TEMPLATE(BM_Array, Kernel, T)->RangeMultiplier(4)->Range(minSamples, maxSamples)
+
+#define TNM067_INTERPOLATION_BENCHMARKS(Kernel)          \
+    TNM067_INTERPOLATION_BENCHMARK(Kernel, float);       \
+    TNM067_INTERPOLATION_BENCHMARK(Kernel, double);      \
+    TNM067_INTERPOLATION_BENCHMARK(Kernel, vec2);        \
+    TNM067_INTERPOLATION_BENCHMARK(Kernel, vec3);        \
+    TNM067_INTERPOLATION_BENCHMARK(Kernel, vec4)
+
+TNM067_INTERPOLATION_BENCHMARKS(Linear);
+TNM067_INTERPOLATION_BENCHMARKS(Bilinear);
+TNM067_INTERPOLATION_BENCHMARKS(Quadratic);
+TNM067_INTERPOLATION_BENCHMARKS(BiQuadratic);
+TNM067_INTERPOLATION_BENCHMARKS(Barycentric);
+
+#undef TNM067_INTERPOLATION_BENCHMARKS
+#undef TNM067_INTERPOLATION_BENCHMARK
+
+}  // namespace inviwo
@@ -0,0 +1,108 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <benchmark/benchmark.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/resampling.h>
+#include <modules/tnm067lab1/utils/interpolationmethods.h>
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace inviwo {
+
+namespace rs = TNM067::Resampling;
+
+namespace {
+
+constexpr std::array<const char*, 4> methodNames = {"PiecewiseConstant", "Bilinear", "Biquadratic", "Barycentric"};
+
+const size2_t srcSize(1024, 1024);
+const size2_t dstSize(2048, 2048);
+
+template <typename T>
+std::vector<T> sourceImage() {
+    std::vector<T> img(srcSize.x * srcSize.y);
+    for (size_t i = 0; i < img.size(); ++i) img[i] = static_cast<T>((i * 7919) % 251);
+    return img;
+}
+
+/**
+ * Per pixel evaluation with the method selected inside the pixel loop and clamping of every
+ * neighbour, the way the ImageUpsampler used to work. Used as the baseline.
+ */
+template <typename T>
+void upsamplePerPixel(rs::Method method, const T* src, T* dst) {
+    auto at = [&](double x, double y) {
+        const auto ix = rs::clampIndex(static_cast<std::ptrdiff_t>(x), srcSize.x);
+        const auto iy = rs::clampIndex(static_cast<std::ptrdiff_t>(y), srcSize.y);
+        return src[ix + iy * srcSize.x];
+    };
+    for (size_t y = 0; y < dstSize.y; ++y) {
+        for (size_t x = 0; x < dstSize.x; ++x) {
+            const double cx = rs::sourceCoordinate(static_cast<double>(x), srcSize.x, dstSize.x);
+            const double cy = rs::sourceCoordinate(static_cast<double>(y), srcSize.y, dstSize.y);
+            const double fx = std::floor(cx);
+            const double fy = std::floor(cy);
+            T value(0);
+            switch (method) {
+                case rs::Method::PiecewiseConstant:
+                    value = at(std::round(cx), std::round(cy));
+                    break;
+                case rs::Method::Bilinear:
+                    value = TNM067::Interpolation::bilinear(std::array<T, 4>{at(fx, fy), at(fx + 1, fy), at(fx, fy + 1), at(fx + 1, fy + 1)},
+                                                            cx - fx, cy - fy);
+                    break;
+                case rs::Method::Biquadratic: {
+                    std::array<T, 9> v;
+                    for (int j = 0; j < 3; ++j) {
+                        for (int i = 0; i < 3; ++i) v[i + 3 * j] = at(fx + i, fy + j);
+                    }
+                    value = TNM067::Interpolation::biQuadratic(v, (cx - fx) / 2, (cy - fy) / 2);
+                    break;
+                }
+                case rs::Method::Barycentric:
+                    value = TNM067::Interpolation::barycentric(
+                        std::array<T, 4>{at(fx, fy), at(fx + 1, fy), at(fx, fy + 1), at(fx + 1, fy + 1)}, cx - fx, cy - fy);
+                    break;
+            }
+            dst[x + y * dstSize.x] = value;
+        }
+    }
+}
+
+template <typename T>
+void BM_UpsamplePerPixel(benchmark::State& state) {
+    const auto method = static_cast<rs::Method>(state.range(0));
+    const auto src = sourceImage<T>();
+    std::vector<T> dst(dstSize.x * dstSize.y);
+    for (auto _ : state) {
+        upsamplePerPixel(method, src.data(), dst.data());
+        benchmark::DoNotOptimize(dst.data());
+    }
+    state.SetLabel(methodNames[state.range(0)]);
+    state.SetItemsProcessed(state.iterations() * dst.size());
+}
+
+template <typename T>
+void BM_UpsampleSpecialised(benchmark::State& state) {
+    const auto method = static_cast<rs::Method>(state.range(0));
+    const auto src = sourceImage<T>();
+    std::vector<T> dst(dstSize.x * dstSize.y);
+    for (auto _ : state) {
+        rs::resample(method, src.data(), srcSize, dst.data(), dstSize);
+        benchmark::DoNotOptimize(dst.data());
+    }
+    state.SetLabel(methodNames[state.range(0)]);
+    state.SetItemsProcessed(state.iterations() * dst.size());
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_UpsamplePerPixel, float)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_UpsampleSpecialised, float)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_UpsamplePerPixel, unsigned char)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_UpsampleSpecialised, unsigned char)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
+
+}  // namespace inviwo
@@ -0,0 +1,7 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <benchmark/benchmark.h>
+#include <warn/pop>
+
+// Write machine readable results with --benchmark_format=json or --benchmark_out=<file>
+BENCHMARK_MAIN();
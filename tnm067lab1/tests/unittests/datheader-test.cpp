@@ -0,0 +1,38 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/datheader.h>
+
+#include <sstream>
+
+namespace inviwo {
+
+TEST(DatHeaderTests, RoundTrip) {
+    std::stringstream stream;
+    TNM067::writeDatHeader(stream, {"big image.raw", size2_t(100000, 70000), "Vec4UINT8"});
+    const auto header = TNM067::readDatHeader(stream);
+    ASSERT_TRUE(header);
+    EXPECT_EQ("big image.raw", header->rawFile);
+    EXPECT_EQ(size2_t(100000, 70000), header->dims);
+    EXPECT_EQ("Vec4UINT8", header->format);
+}
+
+TEST(DatHeaderTests, KeysAreCaseInsensitive) {
+    std::istringstream stream("rawfile: a.raw\r\nObjectModel: I\nRESOLUTION: 4 3\nformat: FLOAT32\n");
+    const auto header = TNM067::readDatHeader(stream);
+    ASSERT_TRUE(header);
+    EXPECT_EQ("a.raw", header->rawFile);
+    EXPECT_EQ(size2_t(4, 3), header->dims);
+    EXPECT_EQ("FLOAT32", header->format);
+}
+
+TEST(DatHeaderTests, RejectsVolumesAndMissingKeys) {
+    std::istringstream volume("Rawfile: a.raw\nResolution: 4 3 2\nFormat: UINT8\n");
+    EXPECT_FALSE(TNM067::readDatHeader(volume));
+    std::istringstream noFormat("Rawfile: a.raw\nResolution: 4 3 1\n");
+    EXPECT_FALSE(TNM067::readDatHeader(noFormat));
+}
+
+}  // namespace inviwo
@@ -0,0 +1,60 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/dirtyregions.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+auto normalize = [](std::uint16_t v) { return v / 65535.0f; };
+
+}  // namespace
+
+TEST(DirtyRegionsTests, UpdateRowFindsChangedSpan) {
+    std::vector<std::uint16_t> src(10, 100);
+    std::vector<float> cache(src.size(), 0.0f);
+
+    auto span = TNM067::updateRow(src.data(), cache.data(), src.size(), normalize, false);
+    EXPECT_EQ(0u, span.begin);
+    EXPECT_EQ(10u, span.end);
+    EXPECT_FLOAT_EQ(100 / 65535.0f, cache[9]);
+
+    span = TNM067::updateRow(src.data(), cache.data(), src.size(), normalize, false);
+    EXPECT_TRUE(span.empty());
+
+    src[3] = 7;
+    src[6] = 8;
+    span = TNM067::updateRow(src.data(), cache.data(), src.size(), normalize, false);
+    EXPECT_EQ(3u, span.begin);
+    EXPECT_EQ(7u, span.end);
+    EXPECT_FLOAT_EQ(8 / 65535.0f, cache[6]);
+
+    span = TNM067::updateRow(src.data(), cache.data(), src.size(), normalize, true);
+    EXPECT_EQ(0u, span.begin);
+    EXPECT_EQ(10u, span.end);
+}
+
+TEST(DirtyRegionsTests, ChangedRegionsMergeConsecutiveRows) {
+    std::vector<TNM067::RowSpan> spans(8);
+    spans[1] = {4, 6};
+    spans[2] = {2, 5};
+    spans[3] = {5, 9};
+    spans[6] = {0, 1};
+
+    const auto regions = TNM067::changedRegions(spans);
+    ASSERT_EQ(2u, regions.size());
+    EXPECT_EQ(size2_t(2, 1), regions[0].offset);
+    EXPECT_EQ(size2_t(7, 3), regions[0].size);
+    EXPECT_EQ(size2_t(0, 6), regions[1].offset);
+    EXPECT_EQ(size2_t(1, 1), regions[1].size);
+
+    EXPECT_TRUE(TNM067::changedRegions(std::vector<TNM067::RowSpan>(4)).empty());
+}
+
+}  // namespace inviwo
@@ -0,0 +1,44 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/heightfieldchunks.h>
+
+#include <vector>
+
+namespace inviwo {
+
+TEST(HeightfieldChunksTests, RegionsCoverTheImage) {
+    const auto regions = TNM067::chunkRegions(size2_t(300, 130), 128);
+    ASSERT_EQ(6u, regions.size());
+    EXPECT_EQ(size2_t(256, 0), regions[2].offset);
+    EXPECT_EQ(size2_t(44, 128), regions[2].size);
+    EXPECT_EQ(size2_t(128, 128), regions[4].offset);
+    EXPECT_EQ(size2_t(128, 2), regions[4].size);
+    EXPECT_TRUE(TNM067::chunkRegions(size2_t(0, 10), 128).empty());
+}
+
+TEST(HeightfieldChunksTests, OnlyChunksNearAChangeAreRebuilt) {
+    const size2_t dims(40, 20);
+    std::vector<float> values(dims.x * dims.y, 0.5f);
+    TNM067::HeightfieldChunks chunks;
+
+    EXPECT_EQ(8u, chunks.update(values.data(), dims, 10, false).size());
+    EXPECT_TRUE(chunks.update(values.data(), dims, 10, false).empty());
+    EXPECT_EQ(8u, chunks.update(values.data(), dims, 10, true).size());
+
+    // Inside of chunk 1, away from its border
+    values[15 + 5 * dims.x] = 1.0f;
+    EXPECT_EQ(std::vector<size_t>{1}, chunks.update(values.data(), dims, 10, false));
+
+    // The first pixel of chunk 6 is also a neighbor of chunk 1, 2 and 5 before it
+    values[20 + 10 * dims.x] = 1.0f;
+    EXPECT_EQ((std::vector<size_t>{1, 2, 5, 6}), chunks.update(values.data(), dims, 10, false));
+
+    // A new chunk size or image size starts over
+    EXPECT_EQ(2u, chunks.update(values.data(), dims, 20, false).size());
+    EXPECT_EQ(1u, chunks.update(values.data(), size2_t(20, 20), 20, false).size());
+}
+
+}  // namespace inviwo
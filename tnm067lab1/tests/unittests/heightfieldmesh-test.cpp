@@ -0,0 +1,424 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace inviwo {
+
+namespace hf = TNM067::Heightfield;
+
+namespace {
+
+ScalarToColorMapping testColors() {
+    ScalarToColorMapping map;
+    map.setBaseColors({vec4(0, 0, 0, 1), vec4(1, 0, 0, 1), vec4(1)});
+    return map;
+}
+
+// Total area of the triangles whose vertices all have the given normal
+float area(const hf::Geometry& g, const vec3& normal) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < g.indices.size(); i += 3) {
+        const auto a = g.indices[i], b = g.indices[i + 1], c = g.indices[i + 2];
+        if (g.normals[a] != normal || g.normals[b] != normal || g.normals[c] != normal) continue;
+        const vec3 n = glm::cross(g.positions[b] - g.positions[a], g.positions[c] - g.positions[a]);
+        sum += 0.5f * std::sqrt(glm::dot(n, n));
+    }
+    return sum;
+}
+
+// Area of the side walls of one closed column per pixel that are not hidden by a neighbor
+float visibleWallArea(const std::vector<float>& values, size2_t dims, float scale, bool alongX) {
+    float sum = 0.0f;
+    const size_t lines = alongX ? dims.x : dims.y;
+    const size_t length = alongX ? dims.y : dims.x;
+    for (size_t j = 0; j < length; ++j) {
+        for (size_t i = 0; i <= lines; ++i) {
+            auto h = [&](size_t k) {
+                if (k == 0 || k > lines) return 0.0f;
+                return (alongX ? values[(k - 1) + j * dims.x] : values[j + (k - 1) * dims.x]) * scale;
+            };
+            sum += std::abs(h(i) - h(i + 1)) * (alongX ? 1.0f / dims.y : 1.0f / dims.x);
+        }
+    }
+    return sum;
+}
+
+// Positions and normals of every triangle, sorted, for comparing meshes regardless of the order
+// and sharing of their vertices
+std::vector<std::array<float, 18>> triangles(const std::vector<hf::Geometry>& parts) {
+    std::vector<std::array<float, 18>> result;
+    for (const auto& g : parts) {
+        for (size_t i = 0; i < g.indices.size(); i += 3) {
+            std::array<float, 18> t;
+            for (size_t j = 0; j < 3; ++j) {
+                const auto v = g.indices[i + j];
+                for (int k = 0; k < 3; ++k) {
+                    t[6 * j + k] = g.positions[v][k];
+                    t[6 * j + 3 + k] = g.normals[v][k];
+                }
+            }
+            result.push_back(t);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+}  // namespace
+
+TEST(HeightfieldMeshTests, BoxesAreSizedExactly) {
+    const size2_t dims(5, 3);
+    std::vector<float> values(dims.x * dims.y);
+    for (size_t i = 0; i < values.size(); ++i) values[i] = 0.1f * i;
+    const auto map = testColors();
+    const auto g = hf::boxes(values.data(), dims, 0.5f, map);
+
+    ASSERT_EQ(24 * values.size(), g.getVertexCount());
+    ASSERT_EQ(36 * values.size(), g.indices.size());
+    for (size_t i = 0; i < g.indices.size(); ++i) {
+        // Every box only references its own vertices
+        EXPECT_EQ(i / 36, g.indices[i] / 24) << "index " << i;
+    }
+    for (size_t i = 0; i < g.getVertexCount(); ++i) {
+        const float v = values[i / 24];
+        EXPECT_TRUE(g.positions[i].y == 0.0f || g.positions[i].y == v * 0.5f);
+        EXPECT_EQ(map.lookup(v), g.colors[i]);
+    }
+    EXPECT_NEAR(1.0f, area(g, vec3(0, 1, 0)), 1e-5f);
+    EXPECT_NEAR(1.0f, area(g, vec3(0, -1, 0)), 1e-5f);
+}
+
+TEST(HeightfieldMeshTests, FlatImageSharesTopVertices) {
+    const size2_t dims(4, 3);
+    const std::vector<float> values(dims.x * dims.y, 0.5f);
+    const auto g = hf::culledColumns(values.data(), dims, 2.0f, testColors());
+
+    // One top vertex per grid corner, and one wall per border line with shared vertices
+    const size_t top = (dims.x + 1) * (dims.y + 1);
+    const size_t walls = 2 * 2 * (dims.y + 1) + 2 * 2 * (dims.x + 1);
+    EXPECT_EQ(top + walls, g.getVertexCount());
+    EXPECT_EQ(6 * (dims.x * dims.y + 2 * dims.x + 2 * dims.y), g.indices.size());
+    EXPECT_FLOAT_EQ(1.0f, area(g, vec3(0, 1, 0)));
+    EXPECT_FLOAT_EQ(0.0f, area(g, vec3(0, -1, 0)));
+    for (const auto& p : g.positions) EXPECT_TRUE(p.y == 0.0f || p.y == 1.0f);
+}
+
+TEST(HeightfieldMeshTests, WallsCoverOnlyHeightDifferences) {
+    const size2_t dims(2, 1);
+    const std::vector<float> values{0.25f, 0.75f};
+    const auto map = testColors();
+    const auto g = hf::culledColumns(values.data(), dims, 1.0f, map);
+
+    // The step between the two columns faces the lower one and has the color of the higher one
+    size_t stepVertices = 0;
+    for (size_t i = 0; i < g.getVertexCount(); ++i) {
+        if (g.normals[i] != vec3(-1, 0, 0) || g.positions[i].x != 0.5f) continue;
+        ++stepVertices;
+        EXPECT_TRUE(g.positions[i].y == 0.25f || g.positions[i].y == 0.75f);
+        EXPECT_EQ(map.lookup(0.75f), g.colors[i]);
+    }
+    EXPECT_EQ(4u, stepVertices);
+    // The step, 0.5 high, and the border wall of the first column, 0.25 high, both 1 long
+    EXPECT_FLOAT_EQ(0.5f + 0.25f, area(g, vec3(-1, 0, 0)));
+}
+
+TEST(HeightfieldMeshTests, MatchesVisibleFacesOfColumns) {
+    const size2_t dims(13, 9);
+    std::mt19937 rand(18);
+    std::uniform_int_distribution<int> dist(0, 3);
+    std::vector<float> values(dims.x * dims.y);
+    for (auto& v : values) v = dist(rand) / 3.0f;
+    const float scale = 0.5f;
+    const auto g = hf::culledColumns(values.data(), dims, scale, testColors());
+
+    EXPECT_NEAR(1.0f, area(g, vec3(0, 1, 0)), 1e-5f);
+    EXPECT_FLOAT_EQ(0.0f, area(g, vec3(0, -1, 0)));
+    EXPECT_NEAR(visibleWallArea(values, dims, scale, true), area(g, vec3(1, 0, 0)) + area(g, vec3(-1, 0, 0)), 1e-5f);
+    EXPECT_NEAR(visibleWallArea(values, dims, scale, false), area(g, vec3(0, 0, 1)) + area(g, vec3(0, 0, -1)), 1e-5f);
+
+    // Far fewer vertices than the 24 per pixel of closed boxes
+    EXPECT_LT(g.getVertexCount(), 12 * values.size());
+    for (auto i : g.indices) EXPECT_LT(i, g.getVertexCount());
+}
+
+TEST(HeightfieldMeshTests, CulledColumnsFaceTheirNormals) {
+    // Neighbors both higher and lower than each other along both axes and at the image border
+    const size2_t dims(7, 5);
+    std::mt19937 rand(8);
+    std::uniform_int_distribution<int> dist(0, 3);
+    std::vector<float> values(dims.x * dims.y);
+    for (auto& v : values) v = 0.25f * dist(rand);
+
+    const auto g = hf::culledColumns(values.data(), dims, 0.5f, testColors());
+    size_t walls = 0;
+    for (size_t i = 0; i < g.indices.size(); i += 3) {
+        const auto a = g.indices[i], b = g.indices[i + 1], c = g.indices[i + 2];
+        const vec3 n = glm::cross(g.positions[b] - g.positions[a], g.positions[c] - g.positions[a]);
+        EXPECT_GT(glm::dot(n, g.normals[a]), 0.0f) << "triangle " << i / 3;
+        if (g.normals[a].y == 0.0f) ++walls;
+    }
+    EXPECT_GT(walls, 0u);
+}
+
+TEST(HeightfieldMeshTests, TerrainHasOneVertexPerPixel) {
+    const size2_t dims(7, 5);
+    std::vector<float> values(dims.x * dims.y);
+    for (size_t y = 0; y < dims.y; ++y) {
+        for (size_t x = 0; x < dims.x; ++x) values[x + y * dims.x] = 0.1f * x + 0.05f * y;
+    }
+    const float scale = 2.0f;
+    const auto map = testColors();
+    const auto g = hf::terrain(values.data(), dims, scale, map);
+
+    ASSERT_EQ(values.size(), g.getVertexCount());
+    EXPECT_EQ(6 * (dims.x - 1) * (dims.y - 1), g.indices.size());
+    for (auto i : g.indices) EXPECT_LT(i, g.getVertexCount());
+
+    // A plane has the same normal everywhere, also at the border
+    const float slopeX = 0.1f * scale * dims.x;
+    const float slopeZ = 0.05f * scale * dims.y;
+    const vec3 expected = glm::normalize(vec3(-slopeX, 1.0f, -slopeZ));
+    for (size_t i = 0; i < g.getVertexCount(); ++i) {
+        for (int c = 0; c < 3; ++c) EXPECT_NEAR(expected[c], g.normals[i][c], 1e-5f) << "vertex " << i;
+        EXPECT_FLOAT_EQ(values[i] * scale, g.positions[i].y);
+        EXPECT_EQ(map.lookup(values[i]), g.colors[i]);
+    }
+    EXPECT_FLOAT_EQ(0.5f / dims.x, g.positions[0].x);
+    EXPECT_FLOAT_EQ(1.0f - 0.5f / dims.y, g.positions.back().z);
+}
+
+
+TEST(HeightfieldMeshTests, QuadtreeMergesEqualBlocks) {
+    // Left half 0.25, right half 0.75, every 4x4 quadrant is flat
+    const size2_t dims(8, 8);
+    std::vector<float> values(dims.x * dims.y);
+    for (size_t y = 0; y < dims.y; ++y) {
+        for (size_t x = 0; x < dims.x; ++x) values[x + y * dims.x] = x < 4 ? 0.25f : 0.75f;
+    }
+    const auto map = testColors();
+
+    const auto exact = hf::quadtree(values.data(), dims, 1.0f, map, 0.0f, 1000);
+    EXPECT_EQ(4 * 24u, exact.getVertexCount());
+    EXPECT_EQ(4 * 36u, exact.indices.size());
+    EXPECT_NEAR(1.0f, area(exact, vec3(0, 1, 0)), 1e-5f);
+
+    // Within the tolerance the whole image is one box at the middle value
+    const auto merged = hf::quadtree(values.data(), dims, 1.0f, map, 0.5f, 1000);
+    ASSERT_EQ(24u, merged.getVertexCount());
+    for (const auto& p : merged.positions) EXPECT_TRUE(p.y == 0.0f || p.y == 0.5f);
+    EXPECT_EQ(map.lookup(0.5f), merged.colors[0]);
+}
+
+TEST(HeightfieldMeshTests, QuadtreeWithoutToleranceMatchesBoxes) {
+    const size2_t dims(7, 5);
+    std::mt19937 rand(2);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> values(dims.x * dims.y);
+    for (auto& v : values) v = dist(rand);
+    const auto map = testColors();
+
+    const auto g = hf::quadtree(values.data(), dims, 0.5f, map, 0.0f, 1000000);
+    EXPECT_EQ(24 * values.size(), g.getVertexCount());
+    EXPECT_NEAR(1.0f, area(g, vec3(0, 1, 0)), 1e-5f);
+    EXPECT_NEAR(1.0f, area(g, vec3(0, -1, 0)), 1e-5f);
+    for (size_t i = 0; i < g.getVertexCount(); i += 24) {
+        // The top face of each box is the pixel it covers
+        const vec3 center = 0.5f * (g.positions[i + 4] + g.positions[i + 6]);
+        const size_t x = static_cast<size_t>(center.x * dims.x);
+        const size_t y = static_cast<size_t>(center.z * dims.y);
+        EXPECT_FLOAT_EQ(values[x + y * dims.x] * 0.5f, center.y);
+    }
+}
+
+TEST(HeightfieldMeshTests, QuadtreeRespectsTriangleBudget) {
+    const size2_t dims(64, 48);
+    std::mt19937 rand(3);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> values(dims.x * dims.y);
+    for (auto& v : values) v = dist(rand);
+    const auto map = testColors();
+
+    for (size_t budget : {0, 12, 100, 1000, 10000}) {
+        const auto g = hf::quadtree(values.data(), dims, 1.0f, map, 0.0f, budget);
+        EXPECT_LE(g.indices.size() / 3, std::max<size_t>(budget, 12)) << "budget " << budget;
+        EXPECT_GT(g.indices.size() / 3, budget / 2) << "budget " << budget;
+        EXPECT_NEAR(1.0f, area(g, vec3(0, 1, 0)), 1e-4f) << "budget " << budget;
+    }
+}
+
+TEST(HeightfieldMeshTests, RegionsGiveTheSameSurface) {
+    // Few distinct values so that there are flat regions crossing the region borders
+    const size2_t dims(11, 8);
+    std::mt19937 rand(4);
+    std::uniform_int_distribution<int> dist(0, 3);
+    std::vector<float> values(dims.x * dims.y);
+    for (auto& v : values) v = 0.25f * dist(rand);
+    const auto map = testColors();
+
+    using Builder = std::function<hf::Geometry(const hf::Rows&, const TNM067::Region&)>;
+    const std::vector<Builder> builders{
+        [&](const hf::Rows& rows, const TNM067::Region& r) { return hf::boxes(rows, 0.5f, map, r); },
+        [&](const hf::Rows& rows, const TNM067::Region& r) { return hf::culledColumns(rows, 0.5f, map, r); },
+        [&](const hf::Rows& rows, const TNM067::Region& r) { return hf::terrain(rows, 0.5f, map, r); }};
+    for (const auto& build : builders) {
+        const auto whole = build(hf::Rows{values.data(), dims}, TNM067::Region{size2_t(0), dims});
+        std::vector<hf::Geometry> parts;
+        for (size_t y = 0; y < dims.y; y += 3) {
+            for (size_t x = 0; x < dims.x; x += 4) {
+                const size2_t offset(x, y);
+                const size2_t size = glm::min(offset + size2_t(4, 3), dims) - offset;
+                // Only the rows of the region, one before and two after it
+                const size_t first = y > 0 ? y - 1 : 0;
+                const size_t last = std::min(dims.y, y + size.y + 2);
+                const std::vector<float> rows(values.begin() + first * dims.x, values.begin() + last * dims.x);
+                parts.push_back(build(hf::Rows{rows.data(), dims, first}, TNM067::Region{offset, size}));
+            }
+        }
+        EXPECT_EQ(triangles({whole}), triangles(parts));
+    }
+}
+
+TEST(HeightfieldMeshTests, SerialMatchesParallel) {
+    const size2_t dims(13, 9);
+    std::mt19937 rand(6);
+    std::uniform_int_distribution<int> dist(0, 4);
+    std::vector<float> values(dims.x * dims.y);
+    for (auto& v : values) v = 0.25f * dist(rand);
+    const auto map = testColors();
+    const hf::Rows image{values.data(), dims};
+    const TNM067::Region region{size2_t(2, 1), size2_t(9, 7)};
+
+    auto expectSame = [](const hf::Geometry& expected, const hf::Geometry& g) {
+        EXPECT_EQ(expected.positions, g.positions);
+        EXPECT_EQ(expected.normals, g.normals);
+        EXPECT_EQ(expected.colors, g.colors);
+        EXPECT_EQ(expected.indices, g.indices);
+    };
+    expectSame(hf::boxes(image, 0.5f, map, region, true),
+               hf::boxes(image, 0.5f, map, region, false));
+    expectSame(hf::terrain(image, 0.5f, map, region, true),
+               hf::terrain(image, 0.5f, map, region, false));
+    expectSame(hf::quadtree(image, 0.5f, map, 0.25f, 200, region, true),
+               hf::quadtree(image, 0.5f, map, 0.25f, 200, region, false));
+}
+
+TEST(HeightfieldMeshTests, RescaleAndRecolorMatchRebuilding) {
+    const size2_t dims(9, 6);
+    std::mt19937 rand(5);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> values(dims.x * dims.y);
+    for (auto& v : values) v = std::round(4.0f * dist(rand)) / 4.0f;
+    const auto map = testColors();
+    ScalarToColorMapping newMap;
+    newMap.setBaseColors({vec4(0, 0, 1, 1), vec4(0, 1, 0, 1)});
+
+    using Builder = hf::Geometry (*)(const float*, size2_t, float, const ScalarToColorMapping&);
+    for (Builder build : {Builder{hf::boxes}, Builder{hf::culledColumns}, Builder{hf::terrain}}) {
+        auto g = build(values.data(), dims, 0.5f, map);
+        const auto expected = build(values.data(), dims, 1.5f, newMap);
+        std::vector<float> heights;
+        for (const auto& p : g.positions) heights.push_back(p.y);
+        const auto normals = g.normals;
+        hf::rescaleHeights(heights, normals, 1.5f / 0.5f, g.positions, g.normals);
+        hf::recolor(g.values, newMap, g.colors);
+
+        ASSERT_EQ(expected.getVertexCount(), g.getVertexCount());
+        for (size_t i = 0; i < g.getVertexCount(); ++i) {
+            for (int k = 0; k < 3; ++k) {
+                EXPECT_NEAR(expected.positions[i][k], g.positions[i][k], 1e-5f) << "vertex " << i;
+                EXPECT_NEAR(expected.normals[i][k], g.normals[i][k], 1e-5f) << "vertex " << i;
+            }
+            EXPECT_EQ(expected.colors[i], g.colors[i]) << "vertex " << i;
+        }
+    }
+}
+
+TEST(HeightfieldMeshTests, RepeatedRescalingDoesNotDrift) {
+    const size2_t dims(9, 6);
+    std::mt19937 rand(7);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> values(dims.x * dims.y);
+    for (auto& v : values) v = dist(rand);
+    const auto map = testColors();
+
+    auto g = hf::terrain(values.data(), dims, 1.0f, map);
+    std::vector<float> heights;
+    for (const auto& p : g.positions) heights.push_back(p.y);
+    const auto normals = g.normals;
+    // Drag the slider back and forth between the ends of its range many times
+    for (int i = 0; i < 1000; ++i) {
+        const float scale = i % 2 == 0 ? 0.001f : 2.0f;
+        hf::rescaleHeights(heights, normals, scale, g.positions, g.normals);
+    }
+    hf::rescaleHeights(heights, normals, 0.7f, g.positions, g.normals);
+
+    const auto expected = hf::terrain(values.data(), dims, 0.7f, map);
+    ASSERT_EQ(expected.getVertexCount(), g.getVertexCount());
+    for (size_t i = 0; i < g.getVertexCount(); ++i) {
+        for (int k = 0; k < 3; ++k) {
+            EXPECT_NEAR(expected.positions[i][k], g.positions[i][k], 1e-6f) << "vertex " << i;
+            EXPECT_NEAR(expected.normals[i][k], g.normals[i][k], 1e-6f) << "vertex " << i;
+        }
+    }
+}
+
+TEST(HeightfieldMeshTests, InstancesAreTwelveBytesPerPixel) {
+    const size2_t dims(300, 200);
+    std::vector<float> values(dims.x * dims.y);
+    for (size_t i = 0; i < values.size(); ++i) values[i] = static_cast<float>(i % 97) / 96.0f;
+    const auto map = testColors();
+
+    const auto box = hf::unitBox();
+    EXPECT_EQ(24u, box.getVertexCount());
+    EXPECT_EQ(36u, box.indices.size());
+    for (const auto& p : box.positions) {
+        for (int k = 0; k < 3; ++k) EXPECT_TRUE(p[k] == 0.0f || p[k] == 1.0f);
+    }
+
+    const auto instances = hf::instances(values.data(), dims, 0.5f, map);
+    ASSERT_EQ(values.size(), instances.size());
+    EXPECT_EQ(12 * values.size(), instances.size() * sizeof(instances[0]));
+
+    const auto boxes = hf::boxes(values.data(), dims, 0.5f, map);
+    for (size_t i = 0; i < instances.size(); i += 1237) {
+        const auto instance = hf::unpack(instances[i]);
+        EXPECT_EQ(i % dims.x, instance.x);
+        EXPECT_EQ(i / dims.x, instance.y);
+        EXPECT_EQ(values[i] * 0.5f, instance.height);
+        EXPECT_EQ(map.lookupPacked(values[i]), instance.color);
+        // The top corner of the box of the same pixel
+        const vec3 corner = boxes.positions[24 * i + 4];
+        EXPECT_NEAR(corner.x, instance.x / 300.0f, 1e-6f);
+        EXPECT_EQ(corner.y, instance.height);
+        EXPECT_NEAR(corner.z, instance.y / 200.0f, 1e-6f);
+    }
+}
+
+TEST(HeightfieldMeshTests, InstancesPackLosslessly) {
+    hf::Instance instance;
+    instance.x = 65535;
+    instance.y = 1234;
+    instance.height = -0.375f;
+    instance.color = glm::u8vec4(1, 2, 3, 255);
+    const auto packed = hf::pack(instance);
+    EXPECT_EQ(65535u | 1234u << 16, packed.x);
+    EXPECT_EQ(0xff030201u, packed.z);
+
+    const auto unpacked = hf::unpack(packed);
+    EXPECT_EQ(instance.x, unpacked.x);
+    EXPECT_EQ(instance.y, unpacked.y);
+    EXPECT_EQ(instance.height, unpacked.height);
+    EXPECT_EQ(instance.color, unpacked.color);
+}
+
+}  // namespace inviwo
@@ -0,0 +1,157 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/heightfieldwriter.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace inviwo {
+
+namespace hf = TNM067::Heightfield;
+
+namespace {
+
+struct Ply {
+    std::uint64_t vertexCount = 0;
+    std::uint64_t faceCount = 0;
+    std::vector<vec3> positions;
+    std::vector<std::array<std::uint32_t, 3>> faces;
+};
+
+Ply readPly(const std::string& data) {
+    Ply ply;
+    const auto end = data.find("end_header\n") + std::string("end_header\n").size();
+    std::istringstream header(data.substr(0, end));
+    for (std::string line; std::getline(header, line);) {
+        std::istringstream words(line);
+        std::string word, element;
+        words >> word >> element;
+        if (word == "element" && element == "vertex") words >> ply.vertexCount;
+        if (word == "element" && element == "face") words >> ply.faceCount;
+    }
+
+    const char* src = data.data() + end;
+    for (std::uint64_t i = 0; i < ply.vertexCount; ++i) {
+        vec3 p;
+        std::memcpy(&p[0], src, sizeof(vec3));
+        ply.positions.push_back(p);
+        src += 6 * sizeof(float) + 4;
+    }
+    for (std::uint64_t i = 0; i < ply.faceCount; ++i) {
+        EXPECT_EQ(3, *src);
+        std::array<std::uint32_t, 3> face;
+        std::memcpy(face.data(), src + 1, sizeof(face));
+        ply.faces.push_back(face);
+        src += 1 + sizeof(face);
+    }
+    EXPECT_EQ(data.data() + data.size(), src);
+    return ply;
+}
+
+// Sorted triangles as the positions of their corners
+template <typename Positions, typename Faces>
+std::vector<std::array<float, 9>> triangles(const Positions& positions, const Faces& faces) {
+    std::vector<std::array<float, 9>> result;
+    for (const auto& face : faces) {
+        std::array<float, 9> t;
+        for (size_t j = 0; j < 3; ++j) {
+            for (int k = 0; k < 3; ++k) t[3 * j + k] = positions[face[j]][k];
+        }
+        result.push_back(t);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+}  // namespace
+
+TEST(HeightfieldWriterTests, StripsGiveTheWholeHeightfield) {
+    const size2_t dims(13, 10);
+    std::mt19937 rand(6);
+    std::uniform_int_distribution<int> dist(0, 3);
+    std::vector<float> values(dims.x * dims.y);
+    for (auto& v : values) v = 0.25f * dist(rand);
+    ScalarToColorMapping map;
+    map.setBaseColors({vec4(0, 0, 0, 1), vec4(1)});
+
+    std::stringstream out;
+    std::stringstream faces;
+    const auto stats = hf::writePly(out, faces, dims, 3, [&](const TNM067::Region& region) {
+        return hf::culledColumns(hf::Rows{values.data(), dims}, 1.0f, map, region);
+    });
+    ASSERT_TRUE(out.good());
+    ASSERT_TRUE(faces.good());
+
+    const auto whole = hf::culledColumns(values.data(), dims, 1.0f, map);
+    EXPECT_EQ(whole.indices.size() / 3, stats.triangles);
+    EXPECT_LT(stats.peakStripVertices, whole.getVertexCount() / 2);
+
+    const auto ply = readPly(out.str());
+    EXPECT_EQ(stats.vertices, ply.vertexCount);
+    EXPECT_EQ(stats.triangles, ply.faceCount);
+
+    std::vector<std::array<std::uint32_t, 3>> wholeFaces;
+    for (size_t i = 0; i < whole.indices.size(); i += 3) {
+        wholeFaces.push_back({whole.indices[i], whole.indices[i + 1], whole.indices[i + 2]});
+    }
+    EXPECT_EQ(triangles(whole.positions, wholeFaces), triangles(ply.positions, ply.faces));
+}
+
+TEST(HeightfieldWriterTests, EmptyImageGivesAValidFile) {
+    std::stringstream out;
+    std::stringstream faces;
+    const auto stats = hf::writePly(out, faces, size2_t(0, 0), 16,
+                                    [](const TNM067::Region&) { return hf::Geometry{}; });
+    EXPECT_EQ(0u, stats.vertices);
+    EXPECT_TRUE(out.good());
+
+    const auto ply = readPly(out.str());
+    EXPECT_EQ(0u, ply.vertexCount);
+    EXPECT_EQ(0u, ply.faceCount);
+}
+
+TEST(HeightfieldWriterTests, StopsBeforeIndicesOverflow) {
+    const size2_t dims(4, 10);
+    std::vector<float> values(dims.x * dims.y, 0.5f);
+    ScalarToColorMapping map;
+
+    // 24 vertices per pixel and 8 pixels per strip, the third strip would pass the limit
+    std::stringstream out;
+    std::stringstream faces;
+    const auto stats = hf::writePly(
+        out, faces, dims, 2,
+        [&](const TNM067::Region& region) { return hf::boxes(hf::Rows{values.data(), dims}, 1.0f, map, region); },
+        {}, 2 * 8 * 24 + 10);
+    EXPECT_TRUE(stats.tooManyVertices);
+    EXPECT_TRUE(out.fail());
+    EXPECT_EQ(2u * 8 * 24, stats.vertices);
+}
+
+TEST(HeightfieldWriterTests, ProgressCanCancel) {
+    const size2_t dims(4, 10);
+    std::vector<float> values(dims.x * dims.y, 0.5f);
+    ScalarToColorMapping map;
+
+    std::vector<float> reported;
+    std::stringstream out;
+    std::stringstream faces;
+    const auto stats = hf::writePly(
+        out, faces, dims, 4,
+        [&](const TNM067::Region& region) { return hf::boxes(hf::Rows{values.data(), dims}, 1.0f, map, region); },
+        [&](float done) {
+            reported.push_back(done);
+            return done < 0.5f;
+        });
+    EXPECT_TRUE(stats.cancelled);
+    EXPECT_EQ((std::vector<float>{0.4f, 0.8f}), reported);
+}
+
+}  // namespace inviwo
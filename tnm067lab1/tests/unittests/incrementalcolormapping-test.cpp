@@ -0,0 +1,63 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/incrementalcolormapping.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace inviwo {
+
+TEST(IncrementalColorMappingTests, OnlyDirtyRowsAreRemapped) {
+    const size2_t dims(8, 6);
+    LayerRAMPrecision<std::uint8_t> layer(dims);
+    auto values = layer.getDataTyped();
+    for (size_t i = 0; i < dims.x * dims.y; ++i) values[i] = static_cast<std::uint8_t>(i * 5);
+
+    LayerColorMapping mapping;
+    mapping.setBaseColors({vec4(0, 0, 0, 1), vec4(1, 0, 0, 1), vec4(1)});
+    IncrementalColorMapping incremental;
+    std::vector<glm::u8vec4> colors(dims.x * dims.y);
+    const auto first = incremental.update(layer, mapping, colors.data(), false);
+    ASSERT_EQ(1u, first.size());
+    EXPECT_EQ(size2_t(0), first[0].offset);
+    EXPECT_EQ(dims, first[0].size);
+
+    // Change pixels in rows 1 and 4 and mark every pixel, only the remapped ones lose the mark
+    values[3 + 1 * dims.x] = 200;
+    values[5 + 1 * dims.x] = 201;
+    values[0 + 4 * dims.x] = 7;
+    const glm::u8vec4 untouched(1, 2, 3, 4);
+    std::fill(colors.begin(), colors.end(), untouched);
+    const auto regions = incremental.update(layer, mapping, colors.data(), false);
+
+    ASSERT_EQ(2u, regions.size());
+    EXPECT_EQ(size2_t(3, 1), regions[0].offset);
+    EXPECT_EQ(size2_t(3, 1), regions[0].size);
+    EXPECT_EQ(size2_t(0, 4), regions[1].offset);
+    EXPECT_EQ(size2_t(1, 1), regions[1].size);
+
+    std::vector<glm::u8vec4> expected(dims.x * dims.y);
+    mapping.map(layer, expected.data());
+    auto dirty = [&](size_t x, size_t y) {
+        return std::any_of(regions.begin(), regions.end(), [&](const TNM067::Region& r) {
+            return x >= r.offset.x && x < r.offset.x + r.size.x && y >= r.offset.y &&
+                   y < r.offset.y + r.size.y;
+        });
+    };
+    for (size_t y = 0; y < dims.y; ++y) {
+        for (size_t x = 0; x < dims.x; ++x) {
+            const size_t i = x + y * dims.x;
+            EXPECT_EQ(dirty(x, y) ? expected[i] : untouched, colors[i]) << x << ", " << y;
+        }
+    }
+
+    // Nothing changed, nothing is remapped
+    EXPECT_TRUE(incremental.update(layer, mapping, colors.data(), false).empty());
+}
+
+}  // namespace inviwo
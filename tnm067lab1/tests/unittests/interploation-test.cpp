@@ -7,6 +7,10 @@
 #include <array>
 #include <modules/tnm067lab1/utils/interpolationmethods.h>
 #include <array>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
 
 namespace inviwo {
 
@@ -447,4 +451,161 @@ TEST(InterpolationTests, BarycentricTest) {
 
 #endif
 
-}  // namespace inviwo
\ No newline at end of file
+#if ENABLE_TRILINEAR_UNITTEST == 1
+TEST(InterpolationTests, TrilinearTest) {
+    // Trilinear interpolation reproduces functions that are linear along each axis
+    auto f = [](float x, float y, float z) { return 0.5f + 2.0f * x - 1.5f * y + 0.25f * z + 3.0f * x * y * z; };
+    std::array<float, 8> v;
+    for (int i = 0; i < 8; ++i) v[i] = f(static_cast<float>(i & 1), static_cast<float>((i >> 1) & 1), static_cast<float>(i >> 2));
+
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_FLOAT_EQ(v[i], ip::trilinear(v, static_cast<float>(i & 1), static_cast<float>((i >> 1) & 1), static_cast<float>(i >> 2)));
+    }
+    for (const auto& p : {vec3(0.5f), vec3(0.1f, 0.7f, 0.3f), vec3(0.9f, 0.2f, 0.6f)}) {
+        EXPECT_NEAR(f(p.x, p.y, p.z), ip::trilinear(v, p.x, p.y, p.z), 1e-5f);
+    }
+    EXPECT_FLOAT_EQ(ip::bilinear(std::array<float, 4>{v[0], v[1], v[2], v[3]}, 0.3f, 0.8f), ip::trilinear(v, 0.3f, 0.8f, 0.0f));
+}
+#endif
+
+#if ENABLE_TRIQUADRATIC_UNITTEST == 1
+TEST(InterpolationTests, TriQuadraticTest) {
+    // The samples lie at 0, 1 and 2 along each axis, x, y and z in [0, 1] span all three
+    auto f = [](double x, double y, double z) { return 1.0 + x * x - 0.5 * y * z + 0.25 * z * z * x; };
+    std::array<double, 27> v;
+    for (int i = 0; i < 27; ++i) v[i] = f(i % 3, (i / 3) % 3, i / 9);
+
+    for (const auto& p : {dvec3(0.0), dvec3(0.5), dvec3(1.0), dvec3(0.1, 0.7, 0.3), dvec3(0.9, 0.2, 0.6)}) {
+        EXPECT_NEAR(f(2 * p.x, 2 * p.y, 2 * p.z), ip::triQuadratic(v, p.x, p.y, p.z), 1e-12);
+    }
+}
+#endif
+
+namespace {
+
+template <typename T>
+struct BatchSamples {
+    using F = typename float_type<T>::type;
+
+    explicit BatchSamples(size_t n) : x(n), y(n), out(n) {
+        std::mt19937 rand(n);
+        std::uniform_real_distribution<double> value(0.0, 255.0);
+        // Also positions outside [0,1] to cover the clamping of linear and bilinear
+        std::uniform_real_distribution<double> pos(-0.25, 1.25);
+        for (auto& c : v) {
+            c.resize(n);
+            for (auto& e : c) e = T(static_cast<float>(value(rand)));
+        }
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = static_cast<F>(pos(rand));
+            y[i] = static_cast<F>(pos(rand));
+        }
+    }
+
+    template <size_t N>
+    std::array<const T*, N> corners() const {
+        std::array<const T*, N> res;
+        for (size_t k = 0; k < N; ++k) res[k] = v[k].data();
+        return res;
+    }
+    template <size_t N>
+    std::array<T, N> corners(size_t i) const {
+        std::array<T, N> res;
+        for (size_t k = 0; k < N; ++k) res[k] = v[k][i];
+        return res;
+    }
+
+    std::array<std::vector<T>, 9> v;
+    std::vector<F> x;
+    std::vector<F> y;
+    std::vector<T> out;
+};
+
+template <typename T>
+void testBatchMatchesSingle() {
+    const size_t n = 100;
+    BatchSamples<T> s(n);
+
+    ip::linear(s.v[0].data(), s.v[1].data(), s.x.data(), s.out.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_EQ(ip::linear(s.v[0][i], s.v[1][i], s.x[i]), s.out[i]);
+
+    ip::bilinear(s.template corners<4>(), s.x.data(), s.y.data(), s.out.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_EQ(ip::bilinear(s.template corners<4>(i), s.x[i], s.y[i]), s.out[i]);
+
+    ip::quadratic(s.v[0].data(), s.v[1].data(), s.v[2].data(), s.x.data(), s.out.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_EQ(ip::quadratic(s.v[0][i], s.v[1][i], s.v[2][i], s.x[i]), s.out[i]);
+
+    ip::biQuadratic(s.template corners<9>(), s.x.data(), s.y.data(), s.out.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_EQ(ip::biQuadratic(s.template corners<9>(i), s.x[i], s.y[i]), s.out[i]);
+
+    ip::barycentric(s.template corners<4>(), s.x.data(), s.y.data(), s.out.data(), n);
+    for (size_t i = 0; i < n; ++i) EXPECT_EQ(ip::barycentric(s.template corners<4>(i), s.x[i], s.y[i]), s.out[i]);
+}
+
+}  // namespace
+
+TEST(InterpolationTests, BatchMatchesSingleSample) {
+    testBatchMatchesSingle<float>();
+    testBatchMatchesSingle<double>();
+    testBatchMatchesSingle<std::uint8_t>();
+    testBatchMatchesSingle<vec3>();
+}
+
+TEST(InterpolationTests, FixedPointRoundsAndSaturates) {
+    namespace fp = ip::FixedPoint;
+    std::uint8_t a = 0;
+    std::uint8_t b = 255;
+    // 207.75 is truncated to 207 by the floating point version
+    EXPECT_EQ(208, fp::linear(a, b, fp::weight<std::uint8_t>(0.81472367048263549805)));
+    EXPECT_EQ(a, fp::linear(a, b, fp::weight<std::uint8_t>(-0.5)));
+    EXPECT_EQ(b, fp::linear(a, b, fp::weight<std::uint8_t>(1.5)));
+    EXPECT_EQ(32768, fp::linear<std::uint16_t>(0, 65535, fp::weight<std::uint16_t>(0.5)));
+
+    // The quadratic overshoots below 0 and above 255
+    EXPECT_EQ(0, fp::quadratic<std::uint8_t>(0, 0, 255, fp::weight<std::uint8_t>(0.25)));
+    EXPECT_EQ(255, fp::quadratic<std::uint8_t>(255, 255, 0, fp::weight<std::uint8_t>(0.25)));
+    EXPECT_EQ(255, fp::quadratic<std::uint8_t>(0, 255, 0, fp::weight<std::uint8_t>(0.5)));
+
+    const u8vec4 v = fp::bilinear(std::array<u8vec4, 4>{u8vec4(0), u8vec4(255), u8vec4(10), u8vec4(20)}, fp::weight<u8vec4>(0.5),
+                                  fp::weight<u8vec4>(0.0));
+    EXPECT_EQ(u8vec4(128), v);
+}
+
+TEST(InterpolationTests, FixedPointMatchesFloatingPoint) {
+    namespace fp = ip::FixedPoint;
+    auto round8 = [](double v) { return std::min(std::max(std::round(v), 0.0), 255.0); };
+    std::mt19937 rand(67);
+    std::uniform_int_distribution<int> value(0, 255);
+    std::uniform_real_distribution<double> pos(0.0, 1.0);
+    for (int i = 0; i < 1000; ++i) {
+        std::array<double, 9> d;
+        std::array<std::uint8_t, 9> v;
+        for (size_t k = 0; k < 9; ++k) {
+            v[k] = static_cast<std::uint8_t>(value(rand));
+            d[k] = v[k];
+        }
+        const double x = pos(rand);
+        const double y = pos(rand);
+        const auto wx = fp::weight<std::uint8_t>(x);
+        const auto wy = fp::weight<std::uint8_t>(y);
+
+        EXPECT_NEAR(round8(ip::linear(d[0], d[1], x)), fp::linear(v[0], v[1], wx), 1.0);
+        EXPECT_NEAR(round8(ip::quadratic(d[0], d[1], d[2], x)), fp::quadratic(v[0], v[1], v[2], wx), 1.0);
+        EXPECT_NEAR(round8(ip::bilinear(std::array<double, 4>{d[0], d[1], d[2], d[3]}, x, y)),
+                    fp::bilinear(std::array<std::uint8_t, 4>{v[0], v[1], v[2], v[3]}, wx, wy), 1.0);
+        EXPECT_NEAR(round8(ip::barycentric(std::array<double, 4>{d[0], d[1], d[2], d[3]}, x, y)),
+                    fp::barycentric(std::array<std::uint8_t, 4>{v[0], v[1], v[2], v[3]}, wx, wy), 1.0);
+        EXPECT_NEAR(round8(ip::biQuadratic(d, x, y)), fp::biQuadratic(v, wx, wy), 1.0);
+    }
+}
+
+TEST(InterpolationTests, VectorFloatTypes) {
+    EXPECT_TRUE((std::is_same<float_type<u8vec4>::type, float>::value));
+    EXPECT_TRUE((std::is_same<float_type<u16vec4>::type, float>::value));
+    EXPECT_TRUE((std::is_same<float_type<vec2>::type, float>::value));
+    EXPECT_TRUE((std::is_same<float_type<ivec3>::type, double>::value));
+    EXPECT_TRUE((std::is_same<float_type<uvec3>::type, double>::value));
+    EXPECT_TRUE((std::is_same<float_type<dvec2>::type, double>::value));
+}
+
+}  // namespace inviwo
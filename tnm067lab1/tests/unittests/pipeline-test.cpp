@@ -0,0 +1,85 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/pipeline.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace inviwo {
+
+TEST(PipelineTests, EveryItemIsStoredOnce) {
+    const size_t count = 500;
+    std::vector<int> stored(count, 0);
+    TNM067::runPipeline(
+        count, 3, 4, [](size_t i) { return static_cast<int>(i); }, [](int v) { return v * 2; },
+        [&](size_t i, int v) {
+            EXPECT_EQ(static_cast<int>(i) * 2, v);
+            ++stored[i];
+        });
+    for (size_t i = 0; i < count; ++i) EXPECT_EQ(1, stored[i]) << "at " << i;
+}
+
+TEST(PipelineTests, ItemsInFlightAreBounded) {
+    const size_t capacity = 2;
+    const size_t mapThreads = 3;
+    std::atomic<size_t> alive{0};
+    std::atomic<size_t> maxAlive{0};
+
+    // Counts the items that have been loaded but not yet stored
+    struct Item {
+        Item(std::atomic<size_t>& alive, std::atomic<size_t>& maxAlive) : alive_{alive} {
+            const size_t now = ++alive_;
+            size_t prev = maxAlive;
+            while (prev < now && !maxAlive.compare_exchange_weak(prev, now)) {
+            }
+        }
+        ~Item() { --alive_; }
+        std::atomic<size_t>& alive_;
+    };
+
+    size_t storedCount = 0;
+    TNM067::runPipeline(
+        200, capacity, mapThreads,
+        [&](size_t) { return std::make_unique<Item>(alive, maxAlive); },
+        [](std::unique_ptr<Item> item) { return item; },
+        [&](size_t, std::unique_ptr<Item>) { ++storedCount; });
+
+    EXPECT_EQ(200u, storedCount);
+    EXPECT_EQ(0u, alive.load());
+    EXPECT_LE(maxAlive.load(), 2 * capacity + mapThreads + 2);
+}
+
+TEST(PipelineTests, ExceptionsArePropagated) {
+    EXPECT_THROW(TNM067::runPipeline(
+                     1000, 2, 2, [](size_t i) { return i; },
+                     [](size_t i) {
+                         if (i == 10) throw std::runtime_error("map failed");
+                         return i;
+                     },
+                     [](size_t, size_t) {}),
+                 std::runtime_error);
+
+    EXPECT_THROW(TNM067::runPipeline(
+                     1000, 2, 2,
+                     [](size_t i) {
+                         if (i == 10) throw std::runtime_error("load failed");
+                         return i;
+                     },
+                     [](size_t i) { return i; }, [](size_t, size_t) {}),
+                 std::runtime_error);
+
+    EXPECT_THROW(TNM067::runPipeline(
+                     1000, 2, 2, [](size_t i) { return i; }, [](size_t i) { return i; },
+                     [](size_t i, size_t) {
+                         if (i == 10) throw std::runtime_error("store failed");
+                     }),
+                 std::runtime_error);
+}
+
+}  // namespace inviwo
@@ -0,0 +1,401 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/resampling.h>
+#include <modules/tnm067lab1/utils/interpolationmethods.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace inviwo {
+
+namespace rs = TNM067::Resampling;
+
+namespace {
+
+std::vector<float> testImage(size2_t size) {
+    std::vector<float> img(size.x * size.y);
+    for (size_t y = 0; y < size.y; ++y) {
+        for (size_t x = 0; x < size.x; ++x) {
+            img[x + y * size.x] = std::sin(0.7f * x) + 0.3f * y + 0.01f * x * y;
+        }
+    }
+    return img;
+}
+
+// Direct per-pixel evaluation with clamping of every neighbour
+float reference(rs::Method method, const std::vector<float>& img, size2_t inSize, size2_t outSize, size_t ox, size_t oy) {
+    const double cx = rs::sourceCoordinate(static_cast<double>(ox), inSize.x, outSize.x);
+    const double cy = rs::sourceCoordinate(static_cast<double>(oy), inSize.y, outSize.y);
+    auto at = [&](double x, double y) {
+        const size_t ix = rs::clampIndex(static_cast<std::ptrdiff_t>(x), inSize.x);
+        const size_t iy = rs::clampIndex(static_cast<std::ptrdiff_t>(y), inSize.y);
+        return img[ix + iy * inSize.x];
+    };
+    const double fx = std::floor(cx);
+    const double fy = std::floor(cy);
+
+    switch (method) {
+        case rs::Method::PiecewiseConstant:
+            return at(std::round(cx), std::round(cy));
+        case rs::Method::Bilinear:
+            return TNM067::Interpolation::bilinear(std::array<float, 4>{at(fx, fy), at(fx + 1, fy), at(fx, fy + 1), at(fx + 1, fy + 1)},
+                                                   static_cast<float>(cx - fx), static_cast<float>(cy - fy));
+        case rs::Method::Barycentric:
+            return TNM067::Interpolation::barycentric(std::array<float, 4>{at(fx, fy), at(fx + 1, fy), at(fx, fy + 1), at(fx + 1, fy + 1)},
+                                                      static_cast<float>(cx - fx), static_cast<float>(cy - fy));
+        case rs::Method::Biquadratic: {
+            std::array<float, 9> v;
+            for (int j = 0; j < 3; ++j) {
+                for (int i = 0; i < 3; ++i) v[i + 3 * j] = at(fx + i, fy + j);
+            }
+            return TNM067::Interpolation::biQuadratic(v, static_cast<float>((cx - fx) / 2), static_cast<float>((cy - fy) / 2));
+        }
+    }
+    return 0.0f;
+}
+
+void testAgainstReference(rs::Method method, size2_t inSize, size2_t outSize) {
+    const auto img = testImage(inSize);
+    std::vector<float> out(outSize.x * outSize.y);
+    rs::resample(method, img.data(), inSize, out.data(), outSize);
+
+    for (size_t y = 0; y < outSize.y; ++y) {
+        for (size_t x = 0; x < outSize.x; ++x) {
+            EXPECT_NEAR(reference(method, img, inSize, outSize, x, y), out[x + y * outSize.x], 1e-4f) << "at " << x << ", " << y;
+        }
+    }
+}
+
+template <typename T>
+void testFixedPointAgainstFloatingPoint(rs::Method method, size2_t inSize, size2_t outSize) {
+    const double max = std::numeric_limits<T>::max();
+    const auto img = testImage(inSize);
+    std::vector<T> fixedImg(img.size());
+    std::vector<float> floatImg(img.size());
+    for (size_t i = 0; i < img.size(); ++i) {
+        fixedImg[i] = static_cast<T>(std::round(std::abs(img[i]) * 0.1 * max)) % static_cast<T>(max);
+        floatImg[i] = fixedImg[i];
+    }
+
+    std::vector<T> out(outSize.x * outSize.y);
+    std::vector<float> expected(outSize.x * outSize.y);
+    rs::resample(method, fixedImg.data(), inSize, out.data(), outSize);
+    rs::resample(method, floatImg.data(), inSize, expected.data(), outSize);
+    for (size_t i = 0; i < out.size(); ++i) {
+        // Rounded and saturated instead of truncated, off by at most one from the weight quantisation
+        EXPECT_NEAR(std::min(std::max(std::round(expected[i]), 0.0f), static_cast<float>(max)), out[i], 1.0) << "at " << i;
+    }
+}
+
+std::vector<float> testVolume(size3_t size) {
+    std::vector<float> vol(size.x * size.y * size.z);
+    for (size_t z = 0; z < size.z; ++z) {
+        for (size_t y = 0; y < size.y; ++y) {
+            for (size_t x = 0; x < size.x; ++x) {
+                vol[x + size.x * (y + size.y * z)] = std::sin(0.7f * x) + 0.3f * y - 0.2f * z + 0.01f * x * y * z;
+            }
+        }
+    }
+    return vol;
+}
+
+// Direct per-voxel evaluation with trilinear() and triQuadratic()
+float referenceVoxel(rs::Method method, const std::vector<float>& vol, size3_t inSize, size3_t outSize, size3_t o) {
+    dvec3 c;
+    for (int i = 0; i < 3; ++i) c[i] = rs::sourceCoordinate(static_cast<double>(o[i]), inSize[i], outSize[i]);
+    const dvec3 f = glm::floor(c);
+    auto at = [&](double x, double y, double z) {
+        const size_t ix = rs::clampIndex(static_cast<std::ptrdiff_t>(x), inSize.x);
+        const size_t iy = rs::clampIndex(static_cast<std::ptrdiff_t>(y), inSize.y);
+        const size_t iz = rs::clampIndex(static_cast<std::ptrdiff_t>(z), inSize.z);
+        return vol[ix + inSize.x * (iy + inSize.y * iz)];
+    };
+
+    switch (method) {
+        case rs::Method::PiecewiseConstant:
+            return at(std::round(c.x), std::round(c.y), std::round(c.z));
+        case rs::Method::Bilinear: {
+            std::array<float, 8> v;
+            for (int i = 0; i < 8; ++i) v[i] = at(f.x + (i & 1), f.y + ((i >> 1) & 1), f.z + (i >> 2));
+            return TNM067::Interpolation::trilinear(v, static_cast<float>(c.x - f.x), static_cast<float>(c.y - f.y),
+                                                    static_cast<float>(c.z - f.z));
+        }
+        case rs::Method::Biquadratic:
+        default: {
+            std::array<float, 27> v;
+            for (int i = 0; i < 27; ++i) v[i] = at(f.x + i % 3, f.y + (i / 3) % 3, f.z + i / 9);
+            return TNM067::Interpolation::triQuadratic(v, static_cast<float>((c.x - f.x) / 2), static_cast<float>((c.y - f.y) / 2),
+                                                       static_cast<float>((c.z - f.z) / 2));
+        }
+    }
+}
+
+template <typename T>
+std::vector<T> resampleVolume(rs::Method method, const std::vector<T>& vol, size3_t inSize, size3_t outSize, size3_t brickSize) {
+    std::vector<T> out(outSize.x * outSize.y * outSize.z);
+    auto run = [&](auto resampler) {
+        // Bricks in reverse order to mimic an arbitrary thread schedule
+        const auto bricks = resampler.getBrickCount();
+        for (size_t i = bricks.x * bricks.y * bricks.z; i-- > 0;) {
+            resampler.resampleBrick(vol.data(), out.data(), size3_t(i % bricks.x, (i / bricks.x) % bricks.y, i / (bricks.x * bricks.y)));
+        }
+    };
+    switch (method) {
+        case rs::Method::PiecewiseConstant:
+            run(rs::VolumeResampler<T, rs::Method::PiecewiseConstant>(inSize, outSize, brickSize));
+            break;
+        case rs::Method::Bilinear:
+            run(rs::VolumeResampler<T, rs::Method::Bilinear>(inSize, outSize, brickSize));
+            break;
+        case rs::Method::Biquadratic:
+        default:
+            run(rs::VolumeResampler<T, rs::Method::Biquadratic>(inSize, outSize, brickSize));
+            break;
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST(ResamplingTests, AxisTapsInterior) {
+    const rs::AxisTaps<float> bilinear(rs::Method::Bilinear, 4, 8);
+    EXPECT_EQ(0u, bilinear.interiorBegin);
+    EXPECT_EQ(6u, bilinear.interiorEnd);  // outputs 6 and 7 read source sample 4
+
+    const rs::AxisTaps<float> biquadratic(rs::Method::Biquadratic, 4, 8);
+    EXPECT_EQ(0u, biquadratic.interiorBegin);
+    EXPECT_EQ(4u, biquadratic.interiorEnd);
+
+    const rs::AxisTaps<float> single(rs::Method::Bilinear, 1, 5);
+    EXPECT_EQ(single.interiorBegin, single.interiorEnd);
+}
+
+TEST(ResamplingTests, FixedRatioPhases) {
+    const rs::AxisTaps<float> quad(rs::Method::Bilinear, 100, 400);
+    EXPECT_EQ(4u, quad.phases);
+    for (size_t i = 0; i < quad.size; ++i) {
+        EXPECT_EQ(static_cast<std::ptrdiff_t>(i / 4), quad.first[i]);
+        EXPECT_FLOAT_EQ(0.25f * (i % 4), quad.weights[i * 2 + 1]);
+    }
+
+    const rs::AxisTaps<float> rational(rs::Method::PiecewiseConstant, 20, 30);
+    EXPECT_EQ(3u, rational.phases);
+    for (size_t i = 0; i < rational.size; ++i) {
+        EXPECT_EQ(static_cast<std::ptrdiff_t>(std::round(i * 2.0 / 3.0)), rational.first[i]);
+    }
+
+    const rs::AxisTaps<float> irregular(rs::Method::Bilinear, 231, 838);
+    EXPECT_EQ(838u, irregular.phases);
+}
+
+TEST(ResamplingTests, MatchesPerPixelEvaluation) {
+    for (auto method : {rs::Method::PiecewiseConstant, rs::Method::Bilinear, rs::Method::Biquadratic, rs::Method::Barycentric}) {
+        testAgainstReference(method, size2_t(7, 5), size2_t(23, 17));
+        testAgainstReference(method, size2_t(8, 8), size2_t(16, 16));
+        testAgainstReference(method, size2_t(2, 1), size2_t(9, 3));
+        testAgainstReference(method, size2_t(31, 20), size2_t(124, 30));
+        testAgainstReference(method, size2_t(5, 97), size2_t(11, 300));
+    }
+}
+
+TEST(ResamplingTests, TilingDoesNotChangeResult) {
+    const size2_t inSize(19, 13);
+    const size2_t outSize(71, 45);
+    const auto img = testImage(inSize);
+
+    for (auto method : {rs::Method::PiecewiseConstant, rs::Method::Bilinear, rs::Method::Biquadratic, rs::Method::Barycentric}) {
+        std::vector<float> whole(outSize.x * outSize.y);
+        std::vector<float> out(outSize.x * outSize.y);
+        rs::dispatch(method, [&](auto m) {
+            rs::Resampler<float, decltype(m)::value>(inSize, outSize, outSize).resample(img.data(), whole.data());
+
+            // Evaluate small tiles in reverse order to mimic an arbitrary thread schedule
+            const rs::Resampler<float, decltype(m)::value> tiled(inSize, outSize, size2_t(8, 5));
+            const auto tiles = tiled.getTileCount();
+            for (size_t y = tiles.y; y-- > 0;) {
+                for (size_t x = tiles.x; x-- > 0;) tiled.resampleTile(img.data(), out.data(), size2_t(x, y));
+            }
+        });
+        EXPECT_EQ(whole, out);
+    }
+}
+
+TEST(ResamplingTests, StripsMatchWholeImage) {
+    const size2_t inSize(17, 12);
+    const size2_t outSize(40, 35);
+    const auto img = testImage(inSize);
+
+    for (auto method : {rs::Method::PiecewiseConstant, rs::Method::Bilinear, rs::Method::Biquadratic, rs::Method::Barycentric}) {
+        std::vector<float> whole(outSize.x * outSize.y);
+        rs::resample(method, img.data(), inSize, whole.data(), outSize);
+
+        for (size_t stripHeight : {1, 4, 64}) {
+            std::vector<float> out(outSize.x * outSize.y);
+            std::vector<float> row(inSize.x);
+            size_t nextRow = 0;
+            size_t nextStrip = 0;
+            rs::dispatch(method, [&](auto m) {
+                rs::StripResampler<float, decltype(m)::value>(inSize, outSize, stripHeight)
+                    .run(
+                        [&](size_t y) {
+                            EXPECT_GE(y, nextRow);
+                            nextRow = y + 1;
+                            std::copy_n(img.data() + y * inSize.x, inSize.x, row.data());
+                            return static_cast<const float*>(row.data());
+                        },
+                        [&](const float* pixels, size_t firstRow, size_t rowCount) {
+                            EXPECT_EQ(nextStrip, firstRow);
+                            EXPECT_LE(rowCount, stripHeight);
+                            nextStrip = firstRow + rowCount;
+                            std::copy_n(pixels, rowCount * outSize.x, out.data() + firstRow * outSize.x);
+                        });
+            });
+            EXPECT_EQ(outSize.y, nextStrip);
+            EXPECT_EQ(whole, out);
+        }
+    }
+}
+
+TEST(ResamplingTests, SinkStopsStrips) {
+    const size2_t inSize(17, 12);
+    const size2_t outSize(40, 35);
+    const auto img = testImage(inSize);
+
+    size_t strips = 0;
+    size_t lastRow = 0;
+    const bool completed = rs::StripResampler<float, rs::Method::Bilinear>(inSize, outSize, 4).run(
+        [&](size_t y) {
+            lastRow = y;
+            return img.data() + y * inSize.x;
+        },
+        [&](const float*, size_t, size_t) { return ++strips < 2; });
+    EXPECT_FALSE(completed);
+    EXPECT_EQ(2u, strips);
+    // Two strips of 4 of 35 output rows only need the first rows of the source
+    EXPECT_LT(lastRow, 4u);
+}
+
+TEST(ResamplingTests, VectorChannelsMatchScalarChannels) {
+    const size2_t inSize(9, 6);
+    const size2_t outSize(20, 14);
+
+    std::array<std::vector<float>, 4> channels;
+    std::vector<vec4> rgba(inSize.x * inSize.y);
+    for (size_t c = 0; c < 4; ++c) {
+        channels[c] = testImage(inSize);
+        for (size_t i = 0; i < rgba.size(); ++i) {
+            channels[c][i] *= 1.0f + c;
+            rgba[i][c] = channels[c][i];
+        }
+    }
+
+    for (auto method : {rs::Method::PiecewiseConstant, rs::Method::Bilinear, rs::Method::Biquadratic, rs::Method::Barycentric}) {
+        std::vector<vec4> out(outSize.x * outSize.y);
+        rs::resample(method, rgba.data(), inSize, out.data(), outSize);
+
+        for (size_t c = 0; c < 4; ++c) {
+            std::vector<float> expected(outSize.x * outSize.y);
+            rs::resample(method, channels[c].data(), inSize, expected.data(), outSize);
+            for (size_t i = 0; i < out.size(); ++i) EXPECT_FLOAT_EQ(expected[i], out[i][c]);
+        }
+    }
+}
+
+TEST(ResamplingTests, FixedPointMatchesFloatingPoint) {
+    for (auto method : {rs::Method::PiecewiseConstant, rs::Method::Bilinear, rs::Method::Biquadratic, rs::Method::Barycentric}) {
+        testFixedPointAgainstFloatingPoint<std::uint8_t>(method, size2_t(7, 5), size2_t(23, 17));
+        testFixedPointAgainstFloatingPoint<std::uint8_t>(method, size2_t(31, 20), size2_t(124, 30));
+        testFixedPointAgainstFloatingPoint<std::uint16_t>(method, size2_t(7, 5), size2_t(23, 17));
+        testFixedPointAgainstFloatingPoint<std::uint16_t>(method, size2_t(31, 20), size2_t(124, 30));
+    }
+}
+
+TEST(ResamplingTests, FixedPointVectorChannelsMatchScalarChannels) {
+    const size2_t inSize(9, 6);
+    const size2_t outSize(20, 14);
+
+    std::array<std::vector<std::uint8_t>, 4> channels;
+    std::vector<u8vec4> rgba(inSize.x * inSize.y);
+    for (size_t c = 0; c < 4; ++c) {
+        channels[c].resize(rgba.size());
+        for (size_t i = 0; i < rgba.size(); ++i) {
+            channels[c][i] = static_cast<std::uint8_t>((i * 37 + c * 101) % 256);
+            rgba[i][static_cast<glm::length_t>(c)] = channels[c][i];
+        }
+    }
+
+    for (auto method : {rs::Method::PiecewiseConstant, rs::Method::Bilinear, rs::Method::Biquadratic, rs::Method::Barycentric}) {
+        std::vector<u8vec4> out(outSize.x * outSize.y);
+        rs::resample(method, rgba.data(), inSize, out.data(), outSize);
+
+        for (size_t c = 0; c < 4; ++c) {
+            std::vector<std::uint8_t> expected(outSize.x * outSize.y);
+            rs::resample(method, channels[c].data(), inSize, expected.data(), outSize);
+            for (size_t i = 0; i < out.size(); ++i) EXPECT_EQ(expected[i], out[i][static_cast<glm::length_t>(c)]);
+        }
+    }
+}
+
+TEST(ResamplingTests, VolumeMatchesPerVoxelEvaluation) {
+    for (auto method : {rs::Method::PiecewiseConstant, rs::Method::Bilinear, rs::Method::Biquadratic}) {
+        for (auto sizes : {std::make_pair(size3_t(4, 5, 3), size3_t(9, 11, 7)), std::make_pair(size3_t(6, 3, 8), size3_t(12, 10, 17))}) {
+            const auto vol = testVolume(sizes.first);
+            const auto out = resampleVolume(method, vol, sizes.first, sizes.second, size3_t(4, 3, 5));
+            for (size_t i = 0; i < out.size(); ++i) {
+                const size3_t o(i % sizes.second.x, (i / sizes.second.x) % sizes.second.y, i / (sizes.second.x * sizes.second.y));
+                EXPECT_NEAR(referenceVoxel(method, vol, sizes.first, sizes.second, o), out[i], 1e-4f) << "at " << i;
+            }
+        }
+    }
+}
+
+TEST(ResamplingTests, VolumeBrickingDoesNotChangeResult) {
+    const size3_t inSize(7, 6, 5);
+    const size3_t outSize(20, 15, 13);
+    const auto vol = testVolume(inSize);
+    std::vector<std::uint8_t> vol8(vol.size());
+    for (size_t i = 0; i < vol.size(); ++i) vol8[i] = static_cast<std::uint8_t>(std::abs(vol[i]) * 40.0f);
+
+    for (auto method : {rs::Method::PiecewiseConstant, rs::Method::Bilinear, rs::Method::Biquadratic}) {
+        EXPECT_EQ(resampleVolume(method, vol, inSize, outSize, outSize), resampleVolume(method, vol, inSize, outSize, size3_t(3, 4, 2)));
+        EXPECT_EQ(resampleVolume(method, vol8, inSize, outSize, outSize), resampleVolume(method, vol8, inSize, outSize, size3_t(3, 4, 2)));
+    }
+}
+
+TEST(ResamplingTests, PyramidLevelSizes) {
+    EXPECT_EQ(size2_t(3, 2), rs::halfSize(size2_t(7, 5)));
+    EXPECT_EQ(size2_t(1, 4), rs::halfSize(size2_t(1, 9)));
+    EXPECT_EQ(size2_t(1, 1), rs::halfSize(size2_t(1, 1)));
+
+    // Odd sizes round down on every level until both sides stop at one pixel
+    std::vector<size2_t> levels{size2_t(13, 3)};
+    while (levels.back() != size2_t(1, 1)) levels.push_back(rs::halfSize(levels.back()));
+    const std::vector<size2_t> expected{size2_t(13, 3), size2_t(6, 1), size2_t(3, 1), size2_t(1, 1)};
+    EXPECT_EQ(expected, levels);
+}
+
+TEST(ResamplingTests, PyramidAverageRoundsToNearest) {
+    using u8 = std::uint8_t;
+    using u16 = std::uint16_t;
+    EXPECT_EQ(u8{2}, rs::average4<u8>(1, 2, 2, 2));  // 1.75, truncating would give 1
+    EXPECT_EQ(u8{1}, rs::average4<u8>(0, 0, 1, 1));  // 0.5 rounds up
+    EXPECT_EQ(u8{1}, rs::average4<u8>(0, 1, 1, 1));  // 0.75
+    EXPECT_EQ(u8{0}, rs::average4<u8>(0, 0, 0, 1));  // 0.25
+    EXPECT_EQ(u8{255}, rs::average4<u8>(255, 255, 255, 255));
+    EXPECT_EQ(u16{65535}, rs::average4<u16>(65535, 65535, 65535, 65534));
+    EXPECT_EQ(2, rs::average4<int>(1, 2, 2, 2));
+    EXPECT_FLOAT_EQ(1.75f, rs::average4<float>(1.0f, 2.0f, 2.0f, 2.0f));
+
+    const glm::u8vec2 v = rs::average4(glm::u8vec2(1, 0), glm::u8vec2(2, 0), glm::u8vec2(2, 1),
+                                       glm::u8vec2(2, 1));
+    EXPECT_EQ(glm::u8vec2(2, 1), v);
+}
+
+}  // namespace inviwo
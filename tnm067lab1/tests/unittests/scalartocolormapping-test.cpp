@@ -0,0 +1,112 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <modules/tnm067lab1/utils/directcolorlut.h>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace inviwo {
+
+TEST(ScalarToColorMappingTests, LookupMatchesSample) {
+    ScalarToColorMapping map;
+    map.setBaseColors({vec4(0, 0, 0, 1), vec4(1, 0, 0, 1), vec4(0.2f, 0.9f, 0.4f, 1), vec4(1)});
+
+    // The steepest slope is 3, red goes from 0 to 1 over a third, times half a table entry
+    const float tolerance = 3.0f / (2 * (ScalarToColorMapping::lutSize - 1)) + 1e-6f;
+    for (int i = 0; i <= 1000; ++i) {
+        const float t = i / 1000.0f;
+        const vec4 expected = map.sample(t);
+        const vec4 res = map.lookup(t);
+        for (int c = 0; c < 4; ++c) EXPECT_NEAR(expected[c], res[c], tolerance) << "at " << t;
+        EXPECT_EQ(u8vec4(res * 255.f), map.lookupPacked(t));
+    }
+
+    EXPECT_EQ(map.sample(0.0f), map.lookup(-1.0f));
+    EXPECT_EQ(map.sample(1.0f), map.lookup(2.0f));
+}
+
+TEST(ScalarToColorMappingTests, LookupFollowsColorChanges) {
+    ScalarToColorMapping map;
+    map.setBaseColors({vec4(0, 0, 0, 1), vec4(1)});
+    EXPECT_EQ(vec4(1), map.lookup(1.0f));
+
+    map.setBaseColors({vec4(0, 0, 0, 1), vec4(0, 0, 1, 1)});
+    EXPECT_EQ(vec4(0, 0, 1, 1), map.lookup(1.0f));
+
+    // 0.5 falls between two table entries, the nearest one is half an entry away
+    const float tolerance = 2.0f / (2 * (ScalarToColorMapping::lutSize - 1)) + 1e-6f;
+    map.addBaseColors(vec4(1, 0, 0, 1));
+    for (int c = 0; c < 4; ++c) EXPECT_NEAR(vec4(0, 0, 1, 1)[c], map.lookup(0.5f)[c], tolerance);
+    EXPECT_EQ(vec4(1, 0, 0, 1), map.lookup(1.0f));
+
+    map.clearColors();
+    for (int c = 0; c < 4; ++c) EXPECT_NEAR(0.5f, map.lookup(0.5f)[c], tolerance);
+}
+
+TEST(ScalarToColorMappingTests, AddingColorsMatchesSettingThem) {
+    const std::vector<vec4> colors{vec4(0, 0, 0, 1), vec4(1, 0, 0, 1), vec4(0.2f, 0.9f, 0.4f, 1),
+                                   vec4(1)};
+    ScalarToColorMapping added;
+    for (const auto& color : colors) added.addBaseColors(color);
+    ScalarToColorMapping set;
+    set.setBaseColors(colors);
+    const ScalarToColorMapping copy(added);
+
+    for (size_t i = 0; i < ScalarToColorMapping::lutSize; ++i) {
+        const float t = static_cast<float>(i) / (ScalarToColorMapping::lutSize - 1);
+        EXPECT_EQ(set.lookup(t), added.lookup(t));
+        EXPECT_EQ(set.lookupPacked(t), copy.lookupPacked(t));
+    }
+}
+
+template <typename T>
+void testDirectColorLUT() {
+    ScalarToColorMapping map;
+    map.setBaseColors({vec4(0, 0, 0, 1), vec4(1, 0, 0, 1), vec4(0.2f, 0.9f, 0.4f, 1), vec4(1)});
+    DirectColorLUT<T> lut;
+    lut.update(map);
+
+    // Every value maps exactly to the converted sample, and 1003 is not a multiple of the 8 pixels
+    // handled per gather so the remainder is covered too
+    std::vector<T> src(1003);
+    for (size_t i = 0; i < src.size(); ++i) src[i] = static_cast<T>(i * 2654435761u);
+    src[0] = 0;
+    src[1] = std::numeric_limits<T>::max();
+    std::vector<u8vec4> dst(src.size());
+    lut.map(src.data(), dst.data(), dst.size());
+    for (size_t i = 0; i < src.size(); ++i) {
+        const float t = static_cast<float>(src[i]) / std::numeric_limits<T>::max();
+        EXPECT_EQ(u8vec4(map.sample(t) * 255.f), dst[i]) << "at " << src[i];
+        EXPECT_EQ(dst[i], lut[src[i]]);
+    }
+
+    map.setBaseColors({vec4(0, 0, 0, 1), vec4(0, 0, 1, 1)});
+    lut.update(map);
+    EXPECT_EQ(u8vec4(0, 0, 255, 255), lut[std::numeric_limits<T>::max()]);
+}
+
+TEST(ScalarToColorMappingTests, DirectLUTUInt8) { testDirectColorLUT<std::uint8_t>(); }
+TEST(ScalarToColorMappingTests, DirectLUTUInt16) { testDirectColorLUT<std::uint16_t>(); }
+
+TEST(ScalarToColorMappingTests, DirectLUTRange) {
+    ScalarToColorMapping map;
+    map.setBaseColors({vec4(0, 0, 0, 1), vec4(1)});
+    DirectColorLUT<std::uint16_t> lut;
+
+    // 12 bit data stored in 16 bits uses the whole color range
+    lut.update(map, dvec2(0.0, 4095.0 / 65535.0));
+    EXPECT_EQ(u8vec4(0, 0, 0, 255), lut[0]);
+    EXPECT_EQ(u8vec4(255), lut[4095]);
+    EXPECT_EQ(u8vec4(255), lut[65535]);
+    EXPECT_EQ(u8vec4(map.sample(2048.0f / 4095.0f) * 255.f), lut[2048]);
+
+    lut.update(map, dvec2(0.5, 0.5));
+    EXPECT_EQ(u8vec4(0, 0, 0, 255), lut[65535]);
+}
+
+}  // namespace inviwo
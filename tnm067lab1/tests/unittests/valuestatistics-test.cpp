@@ -0,0 +1,95 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/valuestatistics.h>
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+// Runs the chunks backwards, the result must not depend on the order
+auto sequential = [](size_t count, auto f) {
+    for (size_t i = count; i-- > 0;) f(i);
+};
+
+}  // namespace
+
+TEST(ValueStatisticsTests, TwelveBitDataInSixteenBits) {
+    std::mt19937 rand(4);
+    std::uniform_int_distribution<int> dist(100, 4000);
+    std::vector<std::uint16_t> data(10007);
+    for (auto& v : data) v = static_cast<std::uint16_t>(dist(rand));
+    data[17] = 4095;
+    data[9000] = 3;
+
+    const auto stats = TNM067::computeStatistics(data.data(), data.size(), 7, 0, sequential);
+    EXPECT_TRUE(stats.exactBins);
+    EXPECT_EQ(data.size(), stats.count);
+    EXPECT_DOUBLE_EQ(3.0 / 65535.0, stats.min);
+    EXPECT_DOUBLE_EQ(4095.0 / 65535.0, stats.max);
+    EXPECT_DOUBLE_EQ(stats.min, stats.percentile(0.0));
+    EXPECT_DOUBLE_EQ(stats.max, stats.percentile(1.0));
+
+    // Clipping one value at each end skips the outliers
+    const double p = 1.5 / data.size();
+    EXPECT_LE(100.0 / 65535.0, stats.percentile(p));
+    EXPECT_GE(4000.0 / 65535.0, stats.percentile(1.0 - p));
+
+    const auto single = TNM067::computeStatistics(data.data(), data.size(), 1, 0, sequential);
+    EXPECT_EQ(single.histogram, stats.histogram);
+}
+
+TEST(ValueStatisticsTests, Percentiles) {
+    std::vector<std::uint8_t> data;
+    for (int v = 0; v < 100; ++v) data.push_back(static_cast<std::uint8_t>(v));
+    const auto stats = TNM067::computeStatistics(data.data(), data.size(), 3, 0, sequential);
+    EXPECT_DOUBLE_EQ(0.0, stats.min);
+    EXPECT_DOUBLE_EQ(99.0 / 255.0, stats.max);
+    EXPECT_DOUBLE_EQ(9.0 / 255.0, stats.percentile(0.1));
+    EXPECT_DOUBLE_EQ(49.0 / 255.0, stats.percentile(0.5));
+    EXPECT_DOUBLE_EQ(89.0 / 255.0, stats.percentile(0.9));
+}
+
+TEST(ValueStatisticsTests, FloatingPoint) {
+    std::vector<float> data;
+    for (int v = 0; v <= 1000; ++v) data.push_back(-2.0f + v * 0.005f);
+    data.push_back(std::numeric_limits<float>::quiet_NaN());
+    data.push_back(std::numeric_limits<float>::infinity());
+    data.push_back(-std::numeric_limits<float>::infinity());
+
+    const auto range = TNM067::computeStatistics(data.data(), data.size(), 5, 0, sequential);
+    EXPECT_FALSE(range.exactBins);
+    EXPECT_EQ(1001u, range.count);
+    EXPECT_FLOAT_EQ(-2.0f, static_cast<float>(range.min));
+    EXPECT_FLOAT_EQ(3.0f, static_cast<float>(range.max));
+    EXPECT_TRUE(range.histogram.empty());
+
+    const auto stats = TNM067::computeStatistics(data.data(), data.size(), 5, 100, sequential);
+    ASSERT_EQ(100u, stats.histogram.size());
+    std::uint64_t sum = 0;
+    for (auto c : stats.histogram) sum += c;
+    EXPECT_EQ(stats.count, sum);
+    // Bins are 0.05 wide, the percentile is the center of the bin it falls in
+    EXPECT_NEAR(0.5, stats.percentile(0.5), 0.05);
+    EXPECT_NEAR(-1.5, stats.percentile(0.1), 0.05);
+}
+
+TEST(ValueStatisticsTests, Empty) {
+    std::vector<float> data(3, std::numeric_limits<float>::quiet_NaN());
+    data.push_back(std::numeric_limits<float>::infinity());
+    const auto stats = TNM067::computeStatistics(data.data(), data.size(), 2, 10, sequential);
+    EXPECT_EQ(0u, stats.count);
+    EXPECT_DOUBLE_EQ(0.0, stats.percentile(0.5));
+
+    const auto none = TNM067::computeStatistics(static_cast<const std::uint8_t*>(nullptr), 0, 4, 0, sequential);
+    EXPECT_EQ(0u, none.count);
+}
+
+}  // namespace inviwo
@@ -0,0 +1,62 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/processors/volumeupsampler.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+using Method = VolumeUpsampler::InterpolationMethod;
+
+template <typename T>
+std::vector<T> upsample(Method method, const std::vector<T>& src, size3_t srcSize,
+                        size3_t dstSize, size3_t brickSize) {
+    std::vector<T> dst(dstSize.x * dstSize.y * dstSize.z);
+    // The bricks are visited last to first to check that their order does not matter
+    VolumeUpsampler::upsample(method, src.data(), srcSize, dst.data(), dstSize, brickSize,
+                              [](size3_t count, auto f) {
+                                  for (size_t z = count.z; z-- > 0;) {
+                                      for (size_t y = count.y; y-- > 0;) {
+                                          for (size_t x = count.x; x-- > 0;) f(size3_t(x, y, z));
+                                      }
+                                  }
+                              });
+    return dst;
+}
+
+}  // namespace
+
+TEST(VolumeUpsamplerTests, BricksMatchSingleBrick) {
+    const size3_t inSize(7, 6, 5);
+    const size3_t outSize(20, 15, 13);
+    std::vector<float> vol(inSize.x * inSize.y * inSize.z);
+    std::vector<std::uint8_t> vol8(vol.size());
+    for (size_t i = 0; i < vol.size(); ++i) {
+        vol[i] = std::sin(0.7f * (i % inSize.x)) + 0.01f * i;
+        vol8[i] = static_cast<std::uint8_t>((i * 37) % 256);
+    }
+
+    for (auto method : {Method::PiecewiseConstant, Method::Trilinear, Method::Triquadratic}) {
+        EXPECT_EQ(upsample(method, vol, inSize, outSize, outSize),
+                  upsample(method, vol, inSize, outSize, size3_t(3, 4, 2)));
+        EXPECT_EQ(upsample(method, vol8, inSize, outSize, outSize),
+                  upsample(method, vol8, inSize, outSize, size3_t(3, 4, 2)));
+    }
+}
+
+TEST(VolumeUpsamplerTests, MethodsMapToAxisMethods) {
+    namespace rs = TNM067::Resampling;
+    EXPECT_EQ(rs::Method::PiecewiseConstant,
+              VolumeUpsampler::axisMethod(Method::PiecewiseConstant));
+    EXPECT_EQ(rs::Method::Bilinear, VolumeUpsampler::axisMethod(Method::Trilinear));
+    EXPECT_EQ(rs::Method::Biquadratic, VolumeUpsampler::axisMethod(Method::Triquadratic));
+}
+
+}  // namespace inviwo
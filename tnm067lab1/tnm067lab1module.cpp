@@ -2,6 +2,9 @@
 #include <modules/tnm067lab1/processors/imagetoheightfield.h>
 #include <modules/tnm067lab1/processors/imageupsampler.h>
 #include <modules/tnm067lab1/processors/imagemappingcpu.h>
+#include <modules/tnm067lab1/processors/streamingimageupsampler.h>
+#include <modules/tnm067lab1/processors/imagepyramid.h>
+#include <modules/tnm067lab1/processors/volumeupsampler.h>
 
 namespace inviwo {
 
@@ -14,6 +17,9 @@ TNM067Lab1Module::TNM067Lab1Module(InviwoApplication* app) : InviwoModule(app, "
     registerProcessor<ImageToHeightfield>();
     registerProcessor<ImageUpsampler>();
     registerProcessor<ImageMappingCPU>();
+    registerProcessor<StreamingImageUpsampler>();
+    registerProcessor<ImagePyramid>();
+    registerProcessor<VolumeUpsampler>();
 }
 
 }  // namespace inviwo
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/common/inviwoapplication.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace inviwo {
+namespace TNM067 {
+
+/**
+ * \class BackgroundJob
+ * \brief Runs one long task at a time on the inviwo thread pool
+ * The task gets a Progress to report how far it got and to check whether it was cancelled. The
+ * reports are forwarded to onProgress on the main thread, so it may update widgets. Destroying
+ * the job cancels a running task and waits for it, reports that are still queued for the main
+ * thread are dropped after that. A job is created, started and destroyed on the main thread.
+ */
+class BackgroundJob {
+    struct State {
+        std::atomic<bool> cancelled{false};
+        bool detached = false;  // only used on the main thread
+        std::function<void(float)> onProgress;
+    };
+
+public:
+    class Progress {
+    public:
+        bool cancelled() const { return state_->cancelled; }
+        /**
+         * Reports progress in [0, 1], returns false if the task has been cancelled and should stop
+         */
+        bool report(float progress) const {
+            dispatchFront([state = state_, progress]() {
+                if (!state->detached) state->onProgress(progress);
+            });
+            return !cancelled();
+        }
+
+    private:
+        friend BackgroundJob;
+        explicit Progress(std::shared_ptr<State> state) : state_{std::move(state)} {}
+        std::shared_ptr<State> state_;
+    };
+
+    explicit BackgroundJob(std::function<void(float)> onProgress)
+        : onProgress_{std::move(onProgress)} {}
+    BackgroundJob(const BackgroundJob&) = delete;
+    BackgroundJob& operator=(const BackgroundJob&) = delete;
+    ~BackgroundJob() {
+        cancel();
+        wait();
+        if (state_) state_->detached = true;
+    }
+
+    bool running() const {
+        return result_.valid() &&
+               result_.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+    }
+
+    /**
+     * Starts task(progress) on the thread pool unless a task is running, returns whether it did
+     */
+    template <typename Task>
+    bool start(Task task) {
+        if (running()) return false;
+        if (state_) state_->detached = true;
+        state_ = std::make_shared<State>();
+        state_->onProgress = onProgress_;
+        result_ = dispatchPool(
+            [task = std::move(task), progress = Progress{state_}]() { task(progress); });
+        return true;
+    }
+
+    void cancel() {
+        if (state_) state_->cancelled = true;
+    }
+    void wait() {
+        if (result_.valid()) result_.wait();
+    }
+
+private:
+    std::function<void(float)> onProgress_;
+    std::shared_ptr<State> state_;
+    std::future<void> result_;
+};
+
+}  // namespace TNM067
+}  // namespace inviwo
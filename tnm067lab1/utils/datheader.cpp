@@ -0,0 +1,53 @@
+#include <modules/tnm067lab1/utils/datheader.h>
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <sstream>
+
+namespace inviwo {
+namespace TNM067 {
+
+void writeDatHeader(std::ostream& out, const DatHeader& header) {
+    out << "Rawfile: " << header.rawFile << "\n"
+        << "Resolution: " << header.dims.x << " " << header.dims.y << " 1\n"
+        << "Format: " << header.format << "\n";
+}
+
+std::optional<DatHeader> readDatHeader(std::istream& in) {
+    DatHeader header;
+    bool hasDims = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        const auto colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string key = line.substr(0, colon);
+        key.erase(std::remove_if(key.begin(), key.end(),
+                                 [](unsigned char c) { return std::isspace(c); }),
+                  key.end());
+        std::transform(key.begin(), key.end(), key.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        std::istringstream value(line.substr(colon + 1));
+
+        if (key == "rawfile") {
+            value >> std::ws;
+            std::getline(value, header.rawFile);
+            while (!header.rawFile.empty() && std::isspace(static_cast<unsigned char>(
+                                                  header.rawFile.back()))) {
+                header.rawFile.pop_back();
+            }
+        } else if (key == "resolution") {
+            size_t slices = 1;
+            value >> header.dims.x >> header.dims.y;
+            hasDims = static_cast<bool>(value);
+            if (value >> slices) hasDims = hasDims && slices == 1;
+        } else if (key == "format") {
+            value >> header.format;
+        }
+    }
+    if (header.rawFile.empty() || !hasDims || header.format.empty()) return std::nullopt;
+    return header;
+}
+
+}  // namespace TNM067
+}  // namespace inviwo
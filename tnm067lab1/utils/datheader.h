@@ -0,0 +1,34 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/util/glmvec.h>
+
+#include <iosfwd>
+#include <optional>
+#include <string>
+
+namespace inviwo {
+namespace TNM067 {
+
+/**
+ * \class DatHeader
+ * \brief Describes a raw file of pixels stored row by row, in the .dat format of raw volumes
+ * The image is described as a volume of one slice, so that the raw files of the streaming
+ * upsampler can be opened with the volume readers of inviwo and read back one row at a time.
+ */
+struct IVW_MODULE_TNM067LAB1_API DatHeader {
+    std::string rawFile;  // relative to the directory of the header
+    size2_t dims{0};
+    std::string format;  // name of the DataFormat, e.g. UINT8 or Vec4UINT8
+};
+
+IVW_MODULE_TNM067LAB1_API void writeDatHeader(std::ostream& out, const DatHeader& header);
+
+/**
+ * Reads the keys Rawfile, Resolution and Format, case insensitive, and ignores any others.
+ * Returns nothing if one of them is missing or the resolution has more than one slice.
+ */
+IVW_MODULE_TNM067LAB1_API std::optional<DatHeader> readDatHeader(std::istream& in);
+
+}  // namespace TNM067
+}  // namespace inviwo
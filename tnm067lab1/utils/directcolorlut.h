@@ -0,0 +1,84 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace inviwo {
+
+/**
+ * \class DirectColorLUT
+ * \brief Color table with one entry per possible value of an 8 or 16 bit unsigned integer
+ * Entry i holds the color of the normalized value i / max, converted to 8 bits per channel the
+ * same way as u8vec4(sample(t) * 255.f). Pixels are mapped by indexing the table directly, there is
+ * no conversion to float and no interpolation, and the result is exact for every input value.
+ * An optional normalized range [range.x, range.y] is stretched to [0, 1] before sampling, values
+ * outside of it get the first or last color. The table is only rebuilt when the base colors of
+ * the mapping or the range change.
+ */
+template <typename T>
+class DirectColorLUT {
+    static_assert(std::is_same<T, std::uint8_t>::value || std::is_same<T, std::uint16_t>::value,
+                  "DirectColorLUT is only defined for 8 and 16 bit unsigned integers");
+    static_assert(sizeof(u8vec4) == sizeof(std::int32_t), "u8vec4 has to be a packed 32 bit value");
+
+public:
+    static constexpr size_t size = size_t{std::numeric_limits<T>::max()} + 1;
+
+    /**
+     * Rebuilds the table if the base colors of map or the range differ from the ones it was built
+     * from. An empty range, range.y <= range.x, maps everything to the first color.
+     */
+    void update(const ScalarToColorMapping& map, dvec2 range = dvec2(0.0, 1.0)) {
+        if (!table_.empty() && map.getBaseColors() == baseColors_ && range == range_) return;
+        baseColors_ = map.getBaseColors();
+        range_ = range;
+        table_.resize(size);
+        const double scale = range.y > range.x ? 1.0 / (range.y - range.x) : 0.0;
+        for (size_t i = 0; i < size; ++i) {
+            const double t = (static_cast<double>(i) / (size - 1) - range.x) * scale;
+            table_[i] = u8vec4(map.sample(static_cast<float>(t)) * 255.f);
+        }
+    }
+
+    u8vec4 operator[](T value) const { return table_[value]; }
+
+    /**
+     * Maps the count values in src to colors in dst. With AVX2 eight pixels at a time are widened
+     * to 32 bit indices and fetched with a single gather, the remainder is looked up one by one.
+     */
+    void map(const T* src, u8vec4* dst, size_t count) const {
+        size_t i = 0;
+#if defined(__AVX2__)
+        const auto table = reinterpret_cast<const int*>(table_.data());
+        for (; i + 8 <= count; i += 8) {
+            __m256i indices;
+            if constexpr (sizeof(T) == 1) {
+                indices = _mm256_cvtepu8_epi32(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)));
+            } else {
+                indices = _mm256_cvtepu16_epi32(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                                _mm256_i32gather_epi32(table, indices, 4));
+        }
+#endif
+        for (; i < count; ++i) dst[i] = table_[src[i]];
+    }
+
+private:
+    std::vector<vec4> baseColors_;
+    dvec2 range_{0.0, 1.0};
+    std::vector<u8vec4> table_;
+};
+
+}  // namespace inviwo
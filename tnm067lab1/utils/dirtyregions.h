@@ -0,0 +1,74 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/util/glmvec.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace inviwo {
+namespace TNM067 {
+
+/**
+ * Half open range [begin, end) of pixels in one row, empty if begin == end
+ */
+struct RowSpan {
+    size_t begin = 0;
+    size_t end = 0;
+    bool empty() const { return begin >= end; }
+};
+
+/**
+ * Rectangle of pixels, offset is the lower left corner
+ */
+struct Region {
+    size2_t offset{0};
+    size2_t size{0};
+};
+
+/**
+ * Converts the width values of src with convert and stores the results in cache. Returns the
+ * span of pixels whose cached value changed, with all set every pixel counts as changed.
+ */
+template <typename T, typename C, typename Convert>
+RowSpan updateRow(const T* src, C* cache, size_t width, Convert&& convert, bool all) {
+    RowSpan span{width, 0};
+    for (size_t x = 0; x < width; ++x) {
+        const C value = convert(src[x]);
+        if (all || !(value == cache[x])) {
+            cache[x] = value;
+            span.begin = std::min(span.begin, x);
+            span.end = x + 1;
+        }
+    }
+    if (span.empty()) return RowSpan{};
+    return span;
+}
+
+/**
+ * Merges the changed spans of consecutive rows, spans[y] belongs to row y, into one region per
+ * band of rows that all changed. Each region is as wide as the union of its spans.
+ */
+inline std::vector<Region> changedRegions(const std::vector<RowSpan>& spans) {
+    std::vector<Region> regions;
+    for (size_t y = 0; y < spans.size();) {
+        if (spans[y].empty()) {
+            ++y;
+            continue;
+        }
+        size_t begin = spans[y].begin;
+        size_t end = spans[y].end;
+        size_t last = y;
+        while (last + 1 < spans.size() && !spans[last + 1].empty()) {
+            ++last;
+            begin = std::min(begin, spans[last].begin);
+            end = std::max(end, spans[last].end);
+        }
+        regions.push_back(Region{size2_t{begin, y}, size2_t{end - begin, last - y + 1}});
+        y = last + 1;
+    }
+    return regions;
+}
+
+}  // namespace TNM067
+}  // namespace inviwo
@@ -0,0 +1,70 @@
+#include <modules/tnm067lab1/utils/heightfieldchunks.h>
+#include <inviwo/core/util/imageramutils.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace inviwo {
+namespace TNM067 {
+
+std::vector<Region> chunkRegions(size2_t dims, size_t chunkSize) {
+    std::vector<Region> regions;
+    if (chunkSize == 0) return regions;
+    for (size_t y = 0; y < dims.y; y += chunkSize) {
+        for (size_t x = 0; x < dims.x; x += chunkSize) {
+            const size2_t offset(x, y);
+            regions.push_back(Region{offset, glm::min(offset + size2_t(chunkSize), dims) - offset});
+        }
+    }
+    return regions;
+}
+
+std::uint64_t chunkHash(const float* values, size2_t dims, const Region& region) {
+    const size2_t begin = glm::max(region.offset, size2_t(1)) - size2_t(1);
+    const size2_t end = glm::min(region.offset + region.size + size2_t(2), dims);
+
+    // FNV-1a over the bits of whole values rather than bytes, a chunk is hashed every time the
+    // image changes so this has to stay much cheaper than building its mesh
+    std::uint64_t hash = 14695981039346656037ull;
+    for (size_t y = begin.y; y < end.y; ++y) {
+        for (size_t x = begin.x; x < end.x; ++x) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &values[x + y * dims.x], sizeof(bits));
+            hash = (hash ^ bits) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+std::vector<size_t> HeightfieldChunks::update(const float* values, size2_t dims, size_t chunkSize,
+                                              bool all) {
+    if (dims != dims_ || chunkSize != chunkSize_) {
+        dims_ = dims;
+        chunkSize_ = chunkSize;
+        regions_ = chunkRegions(dims, chunkSize);
+        hashes_.assign(regions_.size(), 0);
+        all = true;
+    }
+
+    std::vector<std::uint64_t> hashes(regions_.size());
+    util::forEachPixelParallel(size2_t{1, regions_.size()}, [&](size2_t i) {
+        hashes[i.y] = chunkHash(values, dims, regions_[i.y]);
+    });
+
+    std::vector<size_t> changed;
+    for (size_t i = 0; i < regions_.size(); ++i) {
+        if (all || hashes[i] != hashes_[i]) changed.push_back(i);
+    }
+    hashes_ = std::move(hashes);
+    return changed;
+}
+
+void HeightfieldChunks::clear() {
+    dims_ = size2_t{0};
+    chunkSize_ = 0;
+    regions_.clear();
+    hashes_.clear();
+}
+
+}  // namespace TNM067
+}  // namespace inviwo
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/utils/dirtyregions.h>
+#include <inviwo/core/util/glmvec.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace inviwo {
+namespace TNM067 {
+
+/**
+ * Splits dims into chunks of chunkSize by chunkSize pixels in row order, the last column and row
+ * of chunks are cut at the image border
+ */
+IVW_MODULE_TNM067LAB1_API std::vector<Region> chunkRegions(size2_t dims, size_t chunkSize);
+
+/**
+ * Hash of the values of region and of the neighbors that the heightfield builders read for the
+ * walls and normals along its border, one row and column of pixels before the region and two after
+ * it, the second for the normals of the terrain vertices it shares with the next region
+ */
+IVW_MODULE_TNM067LAB1_API std::uint64_t chunkHash(const float* values, size2_t dims,
+                                                  const Region& region);
+
+/**
+ * \class HeightfieldChunks
+ * \brief Finds the chunks of a heightfield that have to be rebuilt after the image changed
+ * Keeps the hash of every chunk of the last image. update() hashes the chunks of a new image and
+ * returns the ones whose hash differs, so only the meshes of those have to be rebuilt.
+ */
+class IVW_MODULE_TNM067LAB1_API HeightfieldChunks {
+public:
+    /**
+     * Returns the indices into regions() of the chunks that changed since the last call. All
+     * chunks are returned if all is set, e.g. because a setting of the meshes changed, or if dims
+     * or chunkSize differ from the last call.
+     */
+    std::vector<size_t> update(const float* values, size2_t dims, size_t chunkSize, bool all);
+
+    const std::vector<Region>& regions() const { return regions_; }
+    void clear();
+
+private:
+    size2_t dims_{0};
+    size_t chunkSize_ = 0;
+    std::vector<Region> regions_;
+    std::vector<std::uint64_t> hashes_;
+};
+
+}  // namespace TNM067
+}  // namespace inviwo
@@ -0,0 +1,492 @@
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <inviwo/core/util/imageramutils.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <queue>
+
+namespace inviwo {
+namespace TNM067 {
+namespace Heightfield {
+
+namespace {
+
+constexpr std::uint32_t noVertex = std::numeric_limits<std::uint32_t>::max();
+
+// Side wall on a grid line between the columns before and after it, nullptr means outside
+struct Wall {
+    Wall() = default;
+    Wall(const float* before, const float* after, float heightScale, const vec3& forward) {
+        const float hBefore = before ? *before * heightScale : 0.0f;
+        const float hAfter = after ? *after * heightScale : 0.0f;
+        exists = !(hBefore == hAfter);
+        lo = std::min(hBefore, hAfter);
+        hi = std::max(hBefore, hAfter);
+        // The wall belongs to the higher column and faces the lower one, at the border of the
+        // image it always belongs to the column inside
+        if (before && (!after || hBefore > hAfter)) {
+            owner = *before;
+            normal = forward;
+            ownedByBefore = true;
+        } else {
+            owner = *after;
+            normal = -forward;
+        }
+    }
+
+    bool sameFace(const Wall& other) const {
+        return normal == other.normal && lo == other.lo && hi == other.hi && owner == other.owner;
+    }
+
+    bool exists = false;
+    float lo = 0.0f;
+    float hi = 0.0f;
+    float owner = 0.0f;
+    vec3 normal{0.0f};
+    bool ownedByBefore = false;
+};
+
+// The last wall emitted on a grid line, a wall continuing it with the same face shares its end
+struct LineState {
+    bool continues(const Wall& wall, size_t pos) const {
+        return next == pos && wall.sameFace(last);
+    }
+
+    Wall last;
+    size_t next = std::numeric_limits<size_t>::max();
+    std::uint32_t loEnd = noVertex;
+    std::uint32_t hiEnd = noVertex;
+};
+
+// Adds wall to the line going from start to end, both given at height 0
+void addWall(Geometry& geometry, const ScalarToColorMapping& map, LineState& line, const Wall& wall,
+             size_t pos, const vec3& start, const vec3& end) {
+    const vec4 color = map.lookup(wall.owner);
+    std::uint32_t loStart, hiStart;
+    if (line.continues(wall, pos)) {
+        loStart = line.loEnd;
+        hiStart = line.hiEnd;
+    } else {
+        loStart = geometry.addVertex(start + vec3(0.0f, wall.lo, 0.0f), wall.normal, wall.owner,
+                                     color);
+        hiStart = geometry.addVertex(start + vec3(0.0f, wall.hi, 0.0f), wall.normal, wall.owner,
+                                     color);
+    }
+    const auto loEnd =
+        geometry.addVertex(end + vec3(0.0f, wall.lo, 0.0f), wall.normal, wall.owner, color);
+    const auto hiEnd =
+        geometry.addVertex(end + vec3(0.0f, wall.hi, 0.0f), wall.normal, wall.owner, color);
+    // Front faces are counter clockwise seen from the side the normal points to. The quad lo
+    // start, lo end, hi end turns around cross(end - start, up), which depends on the direction
+    // of the line and on which of the two columns the wall faces, so check it against the normal
+    const vec3 turn = glm::cross(end - start, vec3(0.0f, 1.0f, 0.0f));
+    if (glm::dot(turn, wall.normal) > 0.0f) {
+        geometry.addQuad(loStart, loEnd, hiEnd, hiStart);
+    } else {
+        geometry.addQuad(loStart, hiStart, hiEnd, loEnd);
+    }
+
+    line.last = wall;
+    line.next = pos + 1;
+    line.loEnd = loEnd;
+    line.hiEnd = hiEnd;
+}
+
+// Calls f(size2_t{0, y}) for every y in [0, count), with parallel set spread over the inviwo
+// thread pool, otherwise in order on the calling thread
+template <typename F>
+void forEachRow(size_t count, bool parallel, F&& f) {
+    if (parallel) {
+        util::forEachPixelParallel(size2_t{1, count}, f);
+    } else {
+        for (size_t y = 0; y < count; ++y) f(size2_t{0, y});
+    }
+}
+
+// Calls f(begin, end) in parallel for consecutive blocks of [0, count)
+template <typename F>
+void forEachBlock(size_t count, F&& f) {
+    constexpr size_t blockSize = 4096;
+    forEachRow((count + blockSize - 1) / blockSize, true, [&](size2_t block) {
+        const size_t begin = block.y * blockSize;
+        f(begin, std::min(begin + blockSize, count));
+    });
+}
+
+constexpr size_t verticesPerBox = 24;
+constexpr size_t indicesPerBox = 36;
+
+// Writes box number i, the corner origin on the ground and size along x and z
+void setBox(Geometry& geometry, size_t i, const vec2& corner, const vec2& size, float height,
+            float value, const vec4& color) {
+    const vec3 down(0.0f, -1.0f, 0.0f);
+    const vec3 up(0.0f, 1.0f, 0.0f);
+    const vec3 left(-1.0f, 0.0f, 0.0f);
+    const vec3 right(1.0f, 0.0f, 0.0f);
+    const vec3 front(0.0f, 0.0f, -1.0f);
+    const vec3 back(0.0f, 0.0f, 1.0f);
+
+    // Box Corners
+    const vec3 origin(corner.x, 0.0f, corner.y);
+    const auto zero = origin;
+    const auto px = origin + vec3(size.x, 0.0f, 0.0f);
+    const auto pz = origin + vec3(0.0f, 0.0f, size.y);
+    const auto py = origin + vec3(0.0f, height, 0.0f);
+    const auto pxpy = origin + vec3(size.x, height, 0.0f);
+    const auto pxpz = origin + vec3(size.x, 0.0f, size.y);
+    const auto pypz = origin + vec3(0.0f, height, size.y);
+    const auto pxpypz = origin + vec3(size.x, height, size.y);
+
+    auto vertex = static_cast<std::uint32_t>(verticesPerBox * i);
+    size_t index = indicesPerBox * i;
+    auto face = [&](const vec3& c1, const vec3& c2, const vec3& c3, const vec3& c4,
+                    const vec3& normal) {
+        geometry.setVertex(vertex + 0, c1, normal, value, color);
+        geometry.setVertex(vertex + 1, c2, normal, value, color);
+        geometry.setVertex(vertex + 2, c3, normal, value, color);
+        geometry.setVertex(vertex + 3, c4, normal, value, color);
+        geometry.setQuad(index, vertex + 0, vertex + 1, vertex + 2, vertex + 3);
+        vertex += 4;
+        index += 6;
+    };
+    face(zero, px, pxpz, pz, down);       // Bottom face
+    face(py, pxpy, pxpypz, pypz, up);     // Top face
+    face(zero, pz, pypz, py, left);       // Left face
+    face(px, pxpz, pxpypz, pxpy, right);  // Right face
+    face(zero, px, pxpy, py, front);      // Front face
+    face(pz, pxpz, pxpypz, pypz, back);   // Back face
+}
+
+}  // namespace
+
+Geometry boxes(const Rows& image, float heightScale, const ScalarToColorMapping& map,
+               const Region& region, bool parallel) {
+    const size2_t dims = image.dims;
+    Geometry geometry;
+    const size_t count = region.size.x * region.size.y;
+    geometry.resize(verticesPerBox * count, indicesPerBox * count);
+
+    const vec2 cellSize = 1.0f / vec2(dims);
+    forEachRow(region.size.y, parallel, [&](size2_t row) {
+        const size_t y = region.offset.y + row.y;
+        for (size_t i = 0; i < region.size.x; ++i) {
+            const size_t x = region.offset.x + i;
+            const float value = image(x, y);
+            setBox(geometry, i + row.y * region.size.x, vec2(x, y) * cellSize, cellSize,
+                   value * heightScale, value, map.lookup(value));
+        }
+    });
+
+    return geometry;
+}
+
+Geometry culledColumns(const Rows& image, float heightScale, const ScalarToColorMapping& map,
+                       const Region& region) {
+    const size2_t dims = image.dims;
+    Geometry geometry;
+    if (region.size.x == 0 || region.size.y == 0) return geometry;
+
+    const vec2 cellSize = 1.0f / vec2(dims);
+    const size2_t begin = region.offset;
+    const size2_t end = region.offset + region.size;
+    auto value = [&](size_t x, size_t y) -> const float* {
+        return x < dims.x && y < dims.y ? &image(x, y) : nullptr;
+    };
+    auto inRegion = [&](size_t x, size_t y) {
+        return x >= begin.x && x < end.x && y >= begin.y && y < end.y;
+    };
+    // A wall on a line of the region border is only added if its owner is inside the region,
+    // the region on the other side adds the rest
+    auto owned = [](const Wall& wall, size_t line, size_t first, size_t last) {
+        return wall.exists && (wall.ownedByBefore ? line > first : line < last);
+    };
+    const vec3 up(0.0f, 1.0f, 0.0f);
+    const vec3 right(1.0f, 0.0f, 0.0f);
+    const vec3 back(0.0f, 0.0f, 1.0f);
+
+    // Top corner indices of the current and previous row, in the order (x, z), (x + 1, z),
+    // (x, z + 1), (x + 1, z + 1), indexed relative to the region
+    using Corners = std::array<std::uint32_t, 4>;
+    std::vector<Corners> prevRow(region.size.x);
+    std::vector<Corners> row(region.size.x);
+
+    // One state per grid line, x lines run along z and z lines along x
+    std::vector<LineState> xLines(region.size.x + 1);
+    LineState zLine;
+
+    auto addZLine = [&](size_t z) {
+        zLine = LineState{};
+        const float zPos = z * cellSize.y;
+        for (size_t x = begin.x; x < end.x; ++x) {
+            const Wall wall(z > 0 ? value(x, z - 1) : nullptr, value(x, z), heightScale, back);
+            if (!owned(wall, z, begin.y, end.y)) continue;
+            addWall(geometry, map, zLine, wall, x, vec3(x * cellSize.x, 0.0f, zPos),
+                    vec3((x + 1) * cellSize.x, 0.0f, zPos));
+        }
+    };
+
+    for (size_t y = begin.y; y < end.y; ++y) {
+        for (size_t x = begin.x; x < end.x; ++x) {
+            const float v = *value(x, y);
+            const float height = v * heightScale;
+            const vec4 color = map.lookup(v);
+            auto same = [&](size_t nx, size_t ny) {
+                return inRegion(nx, ny) && *value(nx, ny) == v;
+            };
+
+            // Corners are taken from already emitted neighbors with the same value
+            const size_t i = x - begin.x;
+            Corners c{noVertex, noVertex, noVertex, noVertex};
+            if (x > 0 && same(x - 1, y)) {
+                c[0] = row[i - 1][1];
+                c[2] = row[i - 1][3];
+            }
+            if (y > 0 && same(x, y - 1)) {
+                if (c[0] == noVertex) c[0] = prevRow[i][2];
+                c[1] = prevRow[i][3];
+            }
+            if (c[0] == noVertex && x > 0 && y > 0 && same(x - 1, y - 1)) c[0] = prevRow[i - 1][3];
+            if (c[1] == noVertex && y > 0 && same(x + 1, y - 1)) c[1] = prevRow[i + 1][2];
+
+            const std::array<vec2, 4> offsets{vec2(0.0f, 0.0f), vec2(1.0f, 0.0f), vec2(0.0f, 1.0f),
+                                              vec2(1.0f, 1.0f)};
+            for (size_t i = 0; i < 4; ++i) {
+                if (c[i] != noVertex) continue;
+                const vec2 pos = (vec2(x, y) + offsets[i]) * cellSize;
+                c[i] = geometry.addVertex(vec3(pos.x, height, pos.y), up, v, color);
+            }
+            geometry.addQuad(c[0], c[2], c[3], c[1]);  // counter clockwise seen from above
+            row[i] = c;
+        }
+
+        for (size_t x = begin.x; x <= end.x; ++x) {
+            const Wall wall(x > 0 ? value(x - 1, y) : nullptr, value(x, y), heightScale, right);
+            if (!owned(wall, x, begin.x, end.x)) continue;
+            const float xPos = x * cellSize.x;
+            addWall(geometry, map, xLines[x - begin.x], wall, y, vec3(xPos, 0.0f, y * cellSize.y),
+                    vec3(xPos, 0.0f, (y + 1) * cellSize.y));
+        }
+        addZLine(y);
+        std::swap(row, prevRow);
+    }
+    addZLine(end.y);
+
+    return geometry;
+}
+
+Geometry terrain(const Rows& image, float heightScale, const ScalarToColorMapping& map,
+                 const Region& region, bool parallel) {
+    const size2_t dims = image.dims;
+    Geometry geometry;
+    if (region.size.x == 0 || region.size.y == 0) return geometry;
+
+    // The cells of the region are the ones whose lower left pixel is inside it, so it also needs
+    // the vertices of the next row and column of pixels if there are any
+    const size2_t begin = region.offset;
+    const size2_t end = glm::min(region.offset + region.size + size2_t(1), dims);
+    const size2_t vertexDims = end - begin;
+    const size2_t cellDims = glm::min(region.size, vertexDims - size2_t(1));
+    geometry.resize(vertexDims.x * vertexDims.y, 6 * cellDims.x * cellDims.y);
+
+    const vec2 cellSize = 1.0f / vec2(dims);
+    auto height = [&](size_t x, size_t y) { return image(x, y) * heightScale; };
+
+    // Pixel (x, y) is vertex (x, y) - begin and cell (x, y) - begin writes its indices at
+    // 6 * (x + y * cellDims.x), both relative to the region
+    forEachRow(vertexDims.y, parallel, [&](size2_t row) {
+        const size_t y = begin.y + row.y;
+        const size_t y0 = y > 0 ? y - 1 : y;
+        const size_t y1 = std::min(y + 1, dims.y - 1);
+        for (size_t x = begin.x; x < end.x; ++x) {
+            const size_t x0 = x > 0 ? x - 1 : x;
+            const size_t x1 = std::min(x + 1, dims.x - 1);
+            const float dx =
+                x1 > x0 ? (height(x1, y) - height(x0, y)) / ((x1 - x0) * cellSize.x) : 0.0f;
+            const float dz =
+                y1 > y0 ? (height(x, y1) - height(x, y0)) / ((y1 - y0) * cellSize.y) : 0.0f;
+
+            const size2_t local(x - begin.x, row.y);
+            const auto i = static_cast<std::uint32_t>(local.x + local.y * vertexDims.x);
+            const vec2 pos = (vec2(x, y) + vec2(0.5f)) * cellSize;
+            const float value = image(x, y);
+            geometry.setVertex(i, vec3(pos.x, height(x, y), pos.y),
+                               glm::normalize(vec3(-dx, 1.0f, -dz)), value, map.lookup(value));
+
+            if (local.x < cellDims.x && local.y < cellDims.y) {
+                const auto rowStride = static_cast<std::uint32_t>(vertexDims.x);
+                geometry.setQuad(6 * (local.x + local.y * cellDims.x), i, i + 1, i + 1 + rowStride,
+                                 i + rowStride);
+            }
+        }
+    });
+    return geometry;
+}
+
+namespace {
+
+// Value range of the square blocks of 2^level pixels of a region, clipped to the region
+class MinMaxPyramid {
+public:
+    MinMaxPyramid(const Rows& image, const Region& region, bool parallel)
+        : values_{&image(region.offset.x, region.offset.y)}, stride_{image.dims.x} {
+        dims_.push_back(region.size);
+        while (dims_.back().x > 1 || dims_.back().y > 1) {
+            const size2_t prevDims = dims_.back();
+            const size2_t levelDims = (prevDims + size2_t(1)) / size2_t(2);
+            const size_t level = dims_.size();
+            dims_.push_back(levelDims);
+            levels_.emplace_back(levelDims.x * levelDims.y);
+            auto& ranges = levels_.back();
+            forEachRow(levelDims.y, parallel, [&](size2_t row) {
+                for (size_t x = 0; x < levelDims.x; ++x) {
+                    vec2 r(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+                    for (size_t cy = 2 * row.y; cy < std::min(2 * row.y + 2, prevDims.y); ++cy) {
+                        for (size_t cx = 2 * x; cx < std::min(2 * x + 2, prevDims.x); ++cx) {
+                            const vec2 c = range(level - 1, cx, cy);
+                            r = vec2(std::min(r.x, c.x), std::max(r.y, c.y));
+                        }
+                    }
+                    ranges[x + row.y * levelDims.x] = r;
+                }
+            });
+        }
+    }
+
+    size_t top() const { return dims_.size() - 1; }
+    size2_t dims(size_t level) const { return dims_[level]; }
+    vec2 range(size_t level, size_t x, size_t y) const {
+        if (level == 0) return vec2(values_[x + y * stride_]);
+        return levels_[level - 1][x + y * dims_[level].x];
+    }
+
+private:
+    const float* values_;
+    size_t stride_;
+    std::vector<size2_t> dims_;
+    std::vector<std::vector<vec2>> levels_;
+};
+
+struct Block {
+    size_t level;
+    size2_t pos;  // in blocks of the level
+    vec2 range;
+    float error() const { return range.y - range.x; }
+    bool operator<(const Block& other) const { return error() < other.error(); }
+};
+
+}  // namespace
+
+Geometry quadtree(const Rows& image, float heightScale, const ScalarToColorMapping& map,
+                  float tolerance, size_t triangleBudget, const Region& region, bool parallel) {
+    Geometry geometry;
+    if (region.size.x == 0 || region.size.y == 0) return geometry;
+
+    const MinMaxPyramid pyramid(image, region, parallel);
+    tolerance = std::max(tolerance, 0.0f);
+    const size_t maxBlocks = std::max<size_t>(1, triangleBudget / (indicesPerBox / 3));
+
+    // Always split the block with the largest value range next, so that a budget that runs out
+    // leaves the remaining error as evenly spread as possible
+    std::priority_queue<Block> open;
+    open.push(Block{pyramid.top(), size2_t(0), pyramid.range(pyramid.top(), 0, 0)});
+    while (!open.empty() && open.top().error() > tolerance) {
+        const Block block = open.top();
+        const size2_t childDims = pyramid.dims(block.level - 1);
+        const size2_t first = block.pos * size2_t(2);
+        const size2_t last = glm::min(first + size2_t(2), childDims);
+        const size_t children = (last.x - first.x) * (last.y - first.y);
+        if (open.size() - 1 + children > maxBlocks) break;
+
+        open.pop();
+        for (size_t y = first.y; y < last.y; ++y) {
+            for (size_t x = first.x; x < last.x; ++x) {
+                open.push(
+                    Block{block.level - 1, size2_t(x, y), pyramid.range(block.level - 1, x, y)});
+            }
+        }
+    }
+
+    std::vector<Block> blocks;
+    blocks.reserve(open.size());
+    for (; !open.empty(); open.pop()) blocks.push_back(open.top());
+
+    geometry.resize(verticesPerBox * blocks.size(), indicesPerBox * blocks.size());
+    const vec2 cellSize = 1.0f / vec2(image.dims);
+    forEachRow(blocks.size(), parallel, [&](size2_t i) {
+        const auto& block = blocks[i.y];
+        const size_t side = size_t{1} << block.level;
+        const size2_t begin = block.pos * size2_t(side);
+        const size2_t end = glm::min(begin + size2_t(side), region.size);
+        const float value = 0.5f * (block.range.x + block.range.y);
+        setBox(geometry, i.y, vec2(region.offset + begin) * cellSize, vec2(end - begin) * cellSize,
+               value * heightScale, value, map.lookup(value));
+    });
+    return geometry;
+}
+
+Geometry unitBox() {
+    Geometry geometry;
+    geometry.resize(verticesPerBox, indicesPerBox);
+    setBox(geometry, 0, vec2(0.0f), vec2(1.0f), 1.0f, 1.0f, vec4(1.0f));
+    return geometry;
+}
+
+glm::uvec3 pack(const Instance& instance) {
+    static_assert(sizeof(glm::uvec3) == 12, "Instances are packed into 12 bytes");
+    glm::uvec3 packed;
+    packed.x = std::uint32_t{instance.x} | std::uint32_t{instance.y} << 16;
+    std::memcpy(&packed.y, &instance.height, sizeof(float));
+    std::memcpy(&packed.z, &instance.color[0], sizeof(glm::u8vec4));
+    return packed;
+}
+
+Instance unpack(const glm::uvec3& packed) {
+    Instance instance;
+    instance.x = static_cast<std::uint16_t>(packed.x & 0xffffu);
+    instance.y = static_cast<std::uint16_t>(packed.x >> 16);
+    std::memcpy(&instance.height, &packed.y, sizeof(float));
+    std::memcpy(&instance.color[0], &packed.z, sizeof(glm::u8vec4));
+    return instance;
+}
+
+std::vector<glm::uvec3> instances(const float* values, size2_t dims, float heightScale,
+                                  const ScalarToColorMapping& map) {
+    std::vector<glm::uvec3> result(dims.x * dims.y);
+    util::forEachPixelParallel(size2_t{1, dims.y}, [&](size2_t row) {
+        for (size_t x = 0; x < dims.x; ++x) {
+            const size_t i = x + row.y * dims.x;
+            Instance instance;
+            instance.x = static_cast<std::uint16_t>(x);
+            instance.y = static_cast<std::uint16_t>(row.y);
+            instance.height = values[i] * heightScale;
+            instance.color = map.lookupPacked(values[i]);
+            result[i] = pack(instance);
+        }
+    });
+    return result;
+}
+
+void rescaleHeights(const std::vector<float>& builtHeights, const std::vector<vec3>& builtNormals,
+                    float factor, std::vector<vec3>& positions, std::vector<vec3>& normals) {
+    // Scaling y by factor maps a normal n to the direction of (n.x * factor, n.y, n.z * factor)
+    forEachBlock(positions.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const vec3& n = builtNormals[i];
+            positions[i].y = builtHeights[i] * factor;
+            normals[i] = glm::normalize(vec3(n.x * factor, n.y, n.z * factor));
+        }
+    });
+}
+
+void recolor(const std::vector<float>& values, const ScalarToColorMapping& map,
+             std::vector<vec4>& colors) {
+    forEachBlock(values.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) colors[i] = map.lookup(values[i]);
+    });
+}
+
+}  // namespace Heightfield
+}  // namespace TNM067
+}  // namespace inviwo
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/utils/dirtyregions.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <inviwo/core/util/glmvec.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace inviwo {
+namespace TNM067 {
+namespace Heightfield {
+
+/**
+ * \class Geometry
+ * \brief Triangle mesh in separate attribute arrays, ready to be moved into mesh buffers
+ * Either grown with addVertex() and addQuad(), or sized once with resize() and filled with
+ * setVertex() and setQuad(), which may be called from several threads for distinct elements.
+ */
+struct IVW_MODULE_TNM067LAB1_API Geometry {
+    std::uint32_t addVertex(const vec3& position, const vec3& normal, float value,
+                            const vec4& color) {
+        positions.push_back(position);
+        normals.push_back(normal);
+        values.push_back(value);
+        colors.push_back(color);
+        return static_cast<std::uint32_t>(positions.size() - 1);
+    }
+    /**
+     * Two triangles, c1 c2 c3 and c1 c3 c4
+     */
+    void addQuad(std::uint32_t c1, std::uint32_t c2, std::uint32_t c3, std::uint32_t c4) {
+        indices.insert(indices.end(), {c1, c2, c3, c1, c3, c4});
+    }
+
+    void resize(size_t vertexCount, size_t indexCount) {
+        positions.resize(vertexCount);
+        normals.resize(vertexCount);
+        values.resize(vertexCount);
+        colors.resize(vertexCount);
+        indices.resize(indexCount);
+    }
+    void setVertex(std::uint32_t i, const vec3& position, const vec3& normal, float value,
+                   const vec4& color) {
+        positions[i] = position;
+        normals[i] = normal;
+        values[i] = value;
+        colors[i] = color;
+    }
+    /**
+     * Like addQuad() but writes the six indices starting at indices[offset]
+     */
+    void setQuad(size_t offset, std::uint32_t c1, std::uint32_t c2, std::uint32_t c3,
+                 std::uint32_t c4) {
+        auto it = indices.begin() + offset;
+        for (auto i : {c1, c2, c3, c1, c3, c4}) *it++ = i;
+    }
+
+    size_t getVertexCount() const { return positions.size(); }
+
+    std::vector<vec3> positions;
+    std::vector<vec3> normals;
+    std::vector<float> values;  // the image value each vertex is colored by, for recolor()
+    std::vector<vec4> colors;
+    std::vector<std::uint32_t> indices;
+};
+
+/**
+ * Rows [first, first + count) of a scalar image of size dims, stored row by row from values. The
+ * builders only read the rows of their region plus one row before and two after it, so a strip
+ * holding those rows is enough to build a region of an image that is not in memory as a whole.
+ */
+struct Rows {
+    const float* values;
+    size2_t dims;
+    size_t first = 0;
+    const float& operator()(size_t x, size_t y) const { return values[x + (y - first) * dims.x]; }
+};
+
+/*
+ * All builders take the full image and optionally a region of it. With a region only the part
+ * of the heightfield that belongs to the pixels of the region is built, in the same coordinates
+ * as for the whole image, while neighboring pixels outside of the region are still read where
+ * they affect it. The geometry of the regions of a partition of the image together gives the
+ * same surface as building the whole image at once, see TNM067::HeightfieldChunks. Only
+ * quadtree() differs, it never merges blocks across the border of a region.
+ *
+ * boxes(), terrain() and quadtree() spread their rows over the inviwo thread pool. Pass parallel
+ * false to run them on the calling thread instead, which is needed when they are called from a
+ * task that already runs on the pool. culledColumns() always runs on the calling thread.
+ */
+
+/**
+ * One closed box per image pixel, 24 vertices and 36 indices each, on the same grid and with the
+ * same heights and colors as culledColumns(). The output is allocated once and the rows are
+ * filled in parallel, pixel i writes to vertices [24 i, 24 i + 24) and indices [36 i, 36 i + 36).
+ */
+IVW_MODULE_TNM067LAB1_API Geometry boxes(const Rows& image, float heightScale,
+                                         const ScalarToColorMapping& map, const Region& region,
+                                         bool parallel = true);
+inline Geometry boxes(const float* values, size2_t dims, float heightScale,
+                      const ScalarToColorMapping& map) {
+    return boxes(Rows{values, dims}, heightScale, map, Region{size2_t(0), dims});
+}
+
+/**
+ * Heightfield of columns on the unit square, one column per image pixel. Pixel (x, y) covers
+ * [x, x + 1] / dims.x along the x axis and [y, y + 1] / dims.y along the z axis, its top is at
+ * values[x + y * dims.x] * heightScale and its color is map.lookup() of the value. Outside of
+ * the image the height is 0.
+ *
+ * Compared to one closed box per pixel there are no bottom faces and a side wall only where two
+ * neighboring columns differ, covering just the difference and colored like the higher column.
+ * Faces with the same normal share vertices: the top corners of neighboring pixels with equal
+ * values, and the ends of consecutive walls along the same grid line that have the same extent
+ * and color. A flat region of any size costs one vertex per pixel and walls only around its
+ * border.
+ */
+IVW_MODULE_TNM067LAB1_API Geometry culledColumns(const Rows& image, float heightScale,
+                                                 const ScalarToColorMapping& map,
+                                                 const Region& region);
+inline Geometry culledColumns(const float* values, size2_t dims, float heightScale,
+                              const ScalarToColorMapping& map) {
+    return culledColumns(Rows{values, dims}, heightScale, map, Region{size2_t(0), dims});
+}
+
+/**
+ * Continuous surface through the pixel centers, one vertex per pixel at
+ * ((x + 0.5) / dims.x, values[x + y * dims.x] * heightScale, (y + 0.5) / dims.y) and two
+ * triangles per cell between four neighboring pixels. Normals come from central differences of
+ * the heights, one sided at the border of the image. Sized exactly up front and filled row by
+ * row in parallel.
+ */
+IVW_MODULE_TNM067LAB1_API Geometry terrain(const Rows& image, float heightScale,
+                                           const ScalarToColorMapping& map, const Region& region,
+                                           bool parallel = true);
+inline Geometry terrain(const float* values, size2_t dims, float heightScale,
+                        const ScalarToColorMapping& map) {
+    return terrain(Rows{values, dims}, heightScale, map, Region{size2_t(0), dims});
+}
+
+/**
+ * Level of detail version of boxes() that merges square blocks of pixels into one box. The
+ * image, or region, is split as a quadtree of blocks of 2^k by 2^k pixels, clipped at the image
+ * border. A block is kept whole if the difference between its largest and smallest value is at
+ * most tolerance, otherwise it is split into its four quadrants, the block with the largest
+ * difference first. Splitting stops early when it would need more than triangleBudget
+ * triangles, 12 per box. Each box gets the middle value of its block, so no pixel is off by more
+ * than half the tolerance unless the budget is reached. With tolerance 0 only blocks of equal
+ * values are merged and the heightfield is the same as boxes().
+ */
+IVW_MODULE_TNM067LAB1_API Geometry quadtree(const Rows& image, float heightScale,
+                                            const ScalarToColorMapping& map, float tolerance,
+                                            size_t triangleBudget, const Region& region,
+                                            bool parallel = true);
+inline Geometry quadtree(const float* values, size2_t dims, float heightScale,
+                         const ScalarToColorMapping& map, float tolerance, size_t triangleBudget) {
+    return quadtree(Rows{values, dims}, heightScale, map, tolerance, triangleBudget,
+                    Region{size2_t(0), dims});
+}
+
+/**
+ * Closed box [0, 1]^3 with 24 vertices and 36 indices in the layout of boxes(), colored white, the
+ * template that the instances() of a heightfield place and scale
+ */
+IVW_MODULE_TNM067LAB1_API Geometry unitBox();
+
+/**
+ * One box of the heightfield as an instance of unitBox(), packed into 12 bytes
+ */
+struct Instance {
+    std::uint16_t x = 0;  // pixel position, the box covers [x, x + 1] x [0, height] x [y, y + 1]
+    std::uint16_t y = 0;
+    float height = 0.0f;
+    glm::u8vec4 color{0};
+};
+
+/**
+ * Packs instance into x | y << 16, the bits of height and the color as RGBA8 with red in the lowest
+ * byte, so that it can be stored in a Buffer<glm::uvec3>
+ */
+IVW_MODULE_TNM067LAB1_API glm::uvec3 pack(const Instance& instance);
+IVW_MODULE_TNM067LAB1_API Instance unpack(const glm::uvec3& packed);
+
+/**
+ * The same heightfield as boxes() as one packed Instance per pixel in row order, 12 bytes instead
+ * of 24 vertices and 36 indices per pixel. Positions are in pixels, scaling them by 1 / dims along
+ * x and z gives the coordinates of boxes(). Images can be at most 65536 pixels wide and high.
+ */
+IVW_MODULE_TNM067LAB1_API std::vector<glm::uvec3> instances(const float* values, size2_t dims,
+                                                            float heightScale,
+                                                            const ScalarToColorMapping& map);
+
+/**
+ * Changes the height scale of an already built heightfield to factor times the one it was built
+ * with. builtHeights and builtNormals are the y coordinates and normals as built, positions and
+ * normals get the scaled ones. Since every change starts from the built state, moving the scale
+ * back and forth does not accumulate rounding errors. For all of the builders the result matches
+ * building again with the new scale up to float rounding.
+ */
+IVW_MODULE_TNM067LAB1_API void rescaleHeights(const std::vector<float>& builtHeights,
+                                              const std::vector<vec3>& builtNormals, float factor,
+                                              std::vector<vec3>& positions,
+                                              std::vector<vec3>& normals);
+
+/**
+ * Sets colors[i] to map.lookup(values[i]), the colors of a built heightfield for new base colors
+ * given the values of Geometry::values
+ */
+IVW_MODULE_TNM067LAB1_API void recolor(const std::vector<float>& values,
+                                       const ScalarToColorMapping& map, std::vector<vec4>& colors);
+
+}  // namespace Heightfield
+}  // namespace TNM067
+}  // namespace inviwo
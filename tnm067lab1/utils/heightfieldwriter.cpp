@@ -0,0 +1,105 @@
+#include <modules/tnm067lab1/utils/heightfieldwriter.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace inviwo {
+namespace TNM067 {
+namespace Heightfield {
+
+namespace {
+
+// Counts are written with a fixed width so that the header does not move when they are filled in
+constexpr int countWidth = 20;
+
+void writeHeader(std::ostream& out, std::uint64_t vertices, std::uint64_t triangles) {
+    out << "ply\n"
+        << "format binary_little_endian 1.0\n"
+        << "comment TNM067 heightfield\n"
+        << "element vertex " << std::setfill('0') << std::setw(countWidth) << vertices << "\n"
+        << "property float x\nproperty float y\nproperty float z\n"
+        << "property float nx\nproperty float ny\nproperty float nz\n"
+        << "property uchar red\nproperty uchar green\nproperty uchar blue\nproperty uchar alpha\n"
+        << "element face " << std::setfill('0') << std::setw(countWidth) << triangles << "\n"
+        << "property list uchar uint vertex_indices\n"
+        << "end_header\n";
+}
+
+// Copies the raw bytes of values, all supported platforms are little endian
+template <typename T>
+void put(char*& dst, const T& value) {
+    std::memcpy(dst, &value, sizeof(T));
+    dst += sizeof(T);
+}
+
+}  // namespace
+
+PlyStats writePly(std::ostream& out, std::iostream& faces, size2_t dims, size_t stripRows,
+                  const std::function<Geometry(const Region&)>& buildStrip,
+                  const std::function<bool(float)>& progress, std::uint64_t maxVertices) {
+    constexpr size_t vertexSize = 6 * sizeof(float) + 4;
+    constexpr size_t faceSize = 1 + 3 * sizeof(std::uint32_t);
+
+    PlyStats stats;
+    const auto headerPos = out.tellp();
+    writeHeader(out, 0, 0);
+
+    std::vector<char> bytes;
+    stripRows = std::max<size_t>(1, stripRows);
+    for (size_t y = 0; y < dims.y; y += stripRows) {
+        const Region strip{size2_t(0, y), size2_t(dims.x, std::min(stripRows, dims.y - y))};
+        const auto geometry = buildStrip(strip);
+        const size_t vertexCount = geometry.getVertexCount();
+        stats.peakStripVertices = std::max(stats.peakStripVertices, vertexCount);
+        if (stats.vertices + vertexCount > maxVertices) {
+            // The indices of this strip would not fit, nothing of it is written
+            stats.tooManyVertices = true;
+            out.setstate(std::ios::failbit);
+            return stats;
+        }
+
+        bytes.resize(vertexCount * vertexSize);
+        char* dst = bytes.data();
+        for (size_t i = 0; i < vertexCount; ++i) {
+            put(dst, geometry.positions[i]);
+            put(dst, geometry.normals[i]);
+            const vec4 color = glm::clamp(geometry.colors[i], vec4(0.0f), vec4(1.0f));
+            put(dst, glm::u8vec4(color * 255.0f + 0.5f));
+        }
+        out.write(bytes.data(), bytes.size());
+
+        // Indices of a strip count from its first vertex, in the file from the first of all
+        const size_t triangleCount = geometry.indices.size() / 3;
+        bytes.resize(triangleCount * faceSize);
+        dst = bytes.data();
+        for (size_t i = 0; i < triangleCount; ++i) {
+            put(dst, std::uint8_t{3});
+            for (size_t j = 0; j < 3; ++j) {
+                put(dst, static_cast<std::uint32_t>(stats.vertices + geometry.indices[3 * i + j]));
+            }
+        }
+        faces.write(bytes.data(), bytes.size());
+
+        stats.vertices += vertexCount;
+        stats.triangles += triangleCount;
+
+        const float done = static_cast<float>(strip.offset.y + strip.size.y) / dims.y;
+        if (progress && !progress(done)) {
+            stats.cancelled = true;
+            return stats;
+        }
+    }
+
+    faces.seekg(0);
+    if (stats.triangles > 0) out << faces.rdbuf();
+    out.seekp(headerPos);
+    writeHeader(out, stats.vertices, stats.triangles);
+    out.seekp(0, std::ios::end);
+    return stats;
+}
+
+}  // namespace Heightfield
+}  // namespace TNM067
+}  // namespace inviwo
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+
+namespace inviwo {
+namespace TNM067 {
+namespace Heightfield {
+
+struct PlyStats {
+    std::uint64_t vertices = 0;
+    std::uint64_t triangles = 0;
+    size_t peakStripVertices = 0;  // the most vertices held in memory at once
+    bool tooManyVertices = false;  // stopped since the indices would not fit in 32 bits
+    bool cancelled = false;        // stopped since progress returned false
+};
+
+/**
+ * Writes the heightfield of an image of size dims to out as a binary little endian PLY file,
+ * vertices with position, normal and RGBA8 color and triangle faces, without holding the whole
+ * mesh in memory. The image is split into strips of stripRows full rows, buildStrip(region)
+ * builds the geometry of one strip, e.g. by passing the region to one of the builders above, and
+ * every strip is written and released before the next one is built.
+ *
+ * PLY stores all vertices before all faces, so the faces are written to the scratch stream faces
+ * first and copied to the end of out when all strips are done. The vertex and face counts in the
+ * header are filled in last, which needs an out that can seek. Check the state of both streams
+ * afterwards for write errors.
+ *
+ * After every strip progress, if given, is called with the fraction of rows done, returning
+ * false stops writing. Indices are 32 bit, so the file can hold at most maxVertices = 2^32
+ * vertices. Writing stops before the first strip that would exceed that, sets the failbit of out
+ * and PlyStats::tooManyVertices. A stopped file is incomplete and should be removed.
+ */
+IVW_MODULE_TNM067LAB1_API PlyStats
+writePly(std::ostream& out, std::iostream& faces, size2_t dims, size_t stripRows,
+         const std::function<Geometry(const Region&)>& buildStrip,
+         const std::function<bool(float)>& progress = {},
+         std::uint64_t maxVertices = std::uint64_t{1} << 32);
+
+}  // namespace Heightfield
+}  // namespace TNM067
+}  // namespace inviwo
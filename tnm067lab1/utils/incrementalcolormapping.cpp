@@ -0,0 +1,83 @@
+#include <modules/tnm067lab1/utils/incrementalcolormapping.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+#include <inviwo/core/util/imageramutils.h>
+
+#include <type_traits>
+
+namespace inviwo {
+
+namespace detail {
+
+// 8 and 16 bit values are cached as they are, everything else as normalized floats
+template <typename T>
+using CacheType = std::conditional_t<
+    std::is_same<T, std::uint8_t>::value || std::is_same<T, std::uint16_t>::value, T, float>;
+
+}  // namespace detail
+
+std::vector<TNM067::Region> IncrementalColorMapping::update(const LayerRAM& layer,
+                                                            const LayerColorMapping& mapping,
+                                                            glm::u8vec4* outPixels,
+                                                            bool recolorAll) {
+    const size2_t dims = layer.getDimensions();
+    if (dims != dims_ || layer.getDataFormat() != format_) {
+        clear();
+        dims_ = dims;
+        format_ = layer.getDataFormat();
+        recolorAll = true;
+    }
+
+    std::vector<TNM067::RowSpan> spans(dims.y);
+    layer.dispatch<void>([&](const auto rep) {
+        using T = std::remove_cv_t<std::remove_pointer_t<decltype(rep->getDataTyped())>>;
+        using C = detail::CacheType<T>;
+        auto& cache = std::get<std::vector<C>>(caches_);
+        cache.resize(dims.x * dims.y);
+        const T* inPixels = rep->getDataTyped();
+
+        // Comparing and recoloring is fused, each row is recolored right after it is compared
+        util::forEachPixelParallel(size2_t{1, dims.y}, [&](size2_t pos) {
+            const size_t offset = pos.y * dims.x;
+            const auto span = TNM067::updateRow(
+                inPixels + offset, cache.data() + offset, dims.x,
+                [](const T& v) -> C {
+                    if constexpr (std::is_same<C, T>::value) {
+                        return v;
+                    } else {
+                        return util::glm_convert_normalized<float>(v);
+                    }
+                },
+                recolorAll);
+            if (!span.empty()) {
+                mapping.mapRow(cache.data() + offset + span.begin, outPixels + offset + span.begin,
+                               span.end - span.begin);
+            }
+            spans[pos.y] = span;
+        });
+    });
+    return TNM067::changedRegions(spans);
+}
+
+void IncrementalColorMapping::recolor(const LayerColorMapping& mapping,
+                                      glm::u8vec4* outPixels) const {
+    auto recolorFrom = [&](const auto& cache) {
+        if (cache.empty()) return;
+        util::forEachPixelParallel(size2_t{1, dims_.y}, [&](size2_t pos) {
+            const size_t offset = pos.y * dims_.x;
+            mapping.mapRow(cache.data() + offset, outPixels + offset, dims_.x);
+        });
+    };
+    recolorFrom(std::get<0>(caches_));
+    recolorFrom(std::get<1>(caches_));
+    recolorFrom(std::get<2>(caches_));
+}
+
+void IncrementalColorMapping::clear() {
+    dims_ = size2_t{0};
+    format_ = nullptr;
+    std::get<0>(caches_).clear();
+    std::get<1>(caches_).clear();
+    std::get<2>(caches_).clear();
+}
+
+}  // namespace inviwo
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/utils/layercolormapping.h>
+#include <modules/tnm067lab1/utils/dirtyregions.h>
+#include <inviwo/core/datastructures/image/layerram.h>
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+namespace inviwo {
+
+/**
+ * \class IncrementalColorMapping
+ * \brief Recolors only the pixels of a layer whose values changed since the previous update
+ * The normalized values of the last layer are cached, 8 and 16 bit values as they are since they
+ * index the exact tables directly and all other formats as normalized floats. Comparing against
+ * the cache gives the changed pixels of every row, only those are normalized and recolored in the
+ * retained output. When only the colors or the range change, recolor() maps the cached values
+ * without touching the layer.
+ */
+class IVW_MODULE_TNM067LAB1_API IncrementalColorMapping {
+public:
+    /**
+     * Brings the cache up to date with layer and recolors the changed pixels of outPixels, which
+     * has to hold the colors of the previous update. Everything is recolored if recolorAll is set
+     * or if the size or format of layer differ from the previous update. Returns the recolored
+     * regions, one per band of consecutive changed rows.
+     */
+    std::vector<TNM067::Region> update(const LayerRAM& layer, const LayerColorMapping& mapping,
+                                       glm::u8vec4* outPixels, bool recolorAll);
+    /**
+     * Recolors every pixel from the cached values, does nothing before the first update()
+     */
+    void recolor(const LayerColorMapping& mapping, glm::u8vec4* outPixels) const;
+    void clear();
+
+private:
+    size2_t dims_{0};
+    const DataFormatBase* format_ = nullptr;
+    std::tuple<std::vector<std::uint8_t>, std::vector<std::uint16_t>, std::vector<float>> caches_;
+};
+
+}  // namespace inviwo
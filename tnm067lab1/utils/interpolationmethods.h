@@ -3,6 +3,14 @@
 #include <modules/tnm067lab1/tnm067lab1moduledefine.h>
 #include <inviwo/core/util/glm.h>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
 
 namespace inviwo {
 
@@ -28,6 +36,14 @@ struct float_type<vec4> {
     using type = float;
 };
 
+// Other vector types use single precision only where it holds every component value exactly,
+// i.e. for 8 and 16 bit components and float, and double precision otherwise
+template <glm::length_t L, typename T, glm::qualifier Q>
+struct float_type<glm::vec<L, T, Q>> {
+    using type = typename std::conditional<sizeof(T) <= 2 || std::is_same<T, float>::value, float,
+                                           double>::type;
+};
+
 namespace TNM067 {
 namespace Interpolation {
 
@@ -68,7 +84,8 @@ T bilinear(const std::array<T, 4> &v, F x, F y) {
 #define ENABLE_QUADRATIC_UNITTEST 1
 template <typename T, typename F = double>
 T quadratic(const T& a, const T& b, const T& c, F x) {
-    return ((1.0 - x) * (1.0 - (2.0 * x)) * a) + (4.0 * x * (1.0 - x) * b) + (x * ((2.0 * x) - 1.0) * c);
+    return ((F(1) - x) * (F(1) - (F(2) * x)) * a) + (F(4) * x * (F(1) - x) * b) +
+           (x * ((F(2) * x) - F(1)) * c);
 }
 
 // clang-format off
@@ -112,14 +129,14 @@ T barycentric(const std::array<T, 4>& v, F x, F y) {
     T P1, P2{v[1]}, P3{v[2]};
     F alpha, beta, gamma;
 
-    if (x + y > 1.0) {
+    if (x + y > F(1)) {
         P1 = v[3];
-        alpha = x + y - 1.0;
-        beta = 1.0 - y;
-        gamma = 1.0 - x;
+        alpha = x + y - F(1);
+        beta = F(1) - y;
+        gamma = F(1) - x;
     } else {
         P1 = v[0];
-        alpha = 1.0 - x - y; // => -alpha from above alpha-calculation
+        alpha = F(1) - x - y; // => -alpha from above alpha-calculation
         beta = x;
         gamma = y;
     }
@@ -127,6 +144,245 @@ T barycentric(const std::array<T, 4>& v, F x, F y) {
     return (alpha * P1) + (beta * P2) + (gamma * P3);
 }
 
+// clang-format off
+    /*
+        6-------7
+       /|      /|
+      4-------5 |
+      | 2-----|-3
+    z |/ y    |/
+      0-------1
+          x
+    */
+// clang-format on
+#define ENABLE_TRILINEAR_UNITTEST 1
+template <typename T, typename F = double>
+T trilinear(const std::array<T, 8>& v, F x, F y, F z) {
+    T bilinearZ1 = bilinear(std::array<T, 4>{v[0], v[1], v[2], v[3]}, x, y);
+    T bilinearZ2 = bilinear(std::array<T, 4>{v[4], v[5], v[6], v[7]}, x, y);
+    return linear(bilinearZ1, bilinearZ2, z);
+}
+
+// The 27 samples are ordered as v[i + 3 * j + 9 * k], three biQuadratic slices along z
+#define ENABLE_TRIQUADRATIC_UNITTEST 1
+template <typename T, typename F = double>
+T triQuadratic(const std::array<T, 27>& v, F x, F y, F z) {
+    std::array<T, 3> slices;
+    for (size_t k = 0; k < 3; ++k) {
+        std::array<T, 9> slice;
+        std::copy_n(v.begin() + 9 * k, 9, slice.begin());
+        slices[k] = biQuadratic(slice, x, y);
+    }
+    return quadratic(slices[0], slices[1], slices[2], z);
+}
+
+/*
+ * Batched versions in structure of arrays form. Sample i has the position x[i] (and y[i]) and
+ * the corner values v[k][i], where k follows the corner numbering of the functions above. The
+ * result of sample i is written to out[i] and equals the one of the single sample version. The
+ * loops are free of branches so that the compiler can vectorise them over the samples.
+ */
+namespace detail {
+
+template <typename T, typename F>
+T linearUnclamped(const T& a, const T& b, F x) {
+    return static_cast<T>((a * (F(1) - x)) + (b * x));
+}
+
+}  // namespace detail
+
+template <typename T, typename F>
+void linear(const T* a, const T* b, const F* x, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        const F t = std::min(std::max(x[i], F(0)), F(1));
+        out[i] = detail::linearUnclamped(a[i], b[i], t);
+    }
+}
+
+template <typename T, typename F>
+void bilinear(const std::array<const T*, 4>& v, const F* x, const F* y, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        const F tx = std::min(std::max(x[i], F(0)), F(1));
+        const F ty = std::min(std::max(y[i], F(0)), F(1));
+        const T linearX1 = detail::linearUnclamped(v[0][i], v[1][i], tx);
+        const T linearX2 = detail::linearUnclamped(v[2][i], v[3][i], tx);
+        out[i] = detail::linearUnclamped(linearX1, linearX2, ty);
+    }
+}
+
+template <typename T, typename F>
+void quadratic(const T* a, const T* b, const T* c, const F* x, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = quadratic(a[i], b[i], c[i], x[i]);
+}
+
+template <typename T, typename F>
+void biQuadratic(const std::array<const T*, 9>& v, const F* x, const F* y, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        const T quadX1 = quadratic(v[0][i], v[1][i], v[2][i], x[i]);
+        const T quadX2 = quadratic(v[3][i], v[4][i], v[5][i], x[i]);
+        const T quadX3 = quadratic(v[6][i], v[7][i], v[8][i], x[i]);
+        out[i] = quadratic(quadX1, quadX2, quadX3, y[i]);
+    }
+}
+
+template <typename T, typename F>
+void barycentric(const std::array<const T*, 4>& v, const F* x, const F* y, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        const bool upper = x[i] + y[i] > F(1);
+        const T P1 = upper ? v[3][i] : v[0][i];
+        const F alpha = upper ? x[i] + y[i] - F(1) : F(1) - x[i] - y[i];
+        const F beta = upper ? F(1) - y[i] : x[i];
+        const F gamma = upper ? F(1) - x[i] : y[i];
+        out[i] = (alpha * P1) + (beta * v[1][i]) + (gamma * v[2][i]);
+    }
+}
+
+/*
+ * Fixed point versions for 8 and 16 bit unsigned samples, and vectors of them. Positions are
+ * integer weights with traits<T>::weightBits fractional bits, see weight(). The weighted samples
+ * are summed exactly in integers and the sum is rounded to the nearest value and saturated to the
+ * range of T once at the end, instead of being converted to double and truncated.
+ */
+namespace FixedPoint {
+
+template <typename T>
+struct is_fixed_point : std::false_type {};
+template <>
+struct is_fixed_point<std::uint8_t> : std::true_type {};
+template <>
+struct is_fixed_point<std::uint16_t> : std::true_type {};
+template <glm::length_t L, typename T, glm::qualifier Q>
+struct is_fixed_point<glm::vec<L, T, Q>> : is_fixed_point<T> {};
+
+template <typename T>
+struct traits;
+
+template <>
+struct traits<std::uint8_t> {
+    using Weight = std::int32_t;
+    using Accum = std::int32_t;
+    // A sample times two weights, including the overshoot of the quadratic weights, fits in 31 bits
+    static constexpr int weightBits = 11;
+};
+template <>
+struct traits<std::uint16_t> {
+    using Weight = std::int64_t;
+    using Accum = std::int64_t;
+    static constexpr int weightBits = 16;
+};
+template <glm::length_t L, typename T, glm::qualifier Q>
+struct traits<glm::vec<L, T, Q>> {
+    using Weight = typename traits<T>::Weight;
+    using Accum = glm::vec<L, typename traits<T>::Accum, Q>;
+    static constexpr int weightBits = traits<T>::weightBits;
+};
+
+namespace detail {
+
+template <typename W, typename F>
+W toWeight(F x, int bits) {
+    return static_cast<W>(std::llround(static_cast<double>(x) * static_cast<double>(W(1) << bits)));
+}
+
+/**
+ * Weights of a, b and c of the quadratic interpolation at x, all with bits fractional bits. They
+ * are rounded individually and the middle one is adjusted so that they sum to exactly one.
+ */
+template <typename W>
+std::array<W, 3> quadraticWeights(W x, int bits) {
+    const W one = W(1) << bits;
+    const W half = W(1) << (bits - 1);
+    const W a = ((one - x) * (one - 2 * x) + half) >> bits;
+    const W c = (x * (2 * x - one) + half) >> bits;
+    return {a, one - a - c, c};
+}
+
+}  // namespace detail
+
+/**
+ * Converts a position in [0, 1] to a weight
+ */
+template <typename T, typename F>
+typename traits<T>::Weight weight(F x) {
+    return detail::toWeight<typename traits<T>::Weight>(x, traits<T>::weightBits);
+}
+
+/**
+ * Rounds sum, a sum of samples weighted with bits fractional bits, to the nearest integer and
+ * saturates it to the range of T
+ */
+template <typename T>
+T narrow(const typename traits<T>::Accum& sum, int bits) {
+    if constexpr (std::is_integral<T>::value) {
+        using Accum = typename traits<T>::Accum;
+        const Accum v = (sum + (Accum(1) << (bits - 1))) >> bits;
+        return static_cast<T>(
+            std::min<Accum>(std::max<Accum>(v, 0), std::numeric_limits<T>::max()));
+    } else {
+        T res;
+        for (glm::length_t i = 0; i < T::length(); ++i) {
+            res[i] = narrow<typename T::value_type>(sum[i], bits);
+        }
+        return res;
+    }
+}
+
+template <typename T>
+T linear(const T& a, const T& b, typename traits<T>::Weight x) {
+    using Accum = typename traits<T>::Accum;
+    using Weight = typename traits<T>::Weight;
+    const Weight one = Weight(1) << traits<T>::weightBits;
+    x = std::min(std::max(x, Weight(0)), one);
+    return narrow<T>(Accum(a) * (one - x) + Accum(b) * x, traits<T>::weightBits);
+}
+
+template <typename T>
+T bilinear(const std::array<T, 4>& v, typename traits<T>::Weight x, typename traits<T>::Weight y) {
+    using Accum = typename traits<T>::Accum;
+    using Weight = typename traits<T>::Weight;
+    const Weight one = Weight(1) << traits<T>::weightBits;
+    x = std::min(std::max(x, Weight(0)), one);
+    y = std::min(std::max(y, Weight(0)), one);
+    const Accum sum = Accum(v[0]) * ((one - x) * (one - y)) + Accum(v[1]) * (x * (one - y)) +
+                      Accum(v[2]) * ((one - x) * y) + Accum(v[3]) * (x * y);
+    return narrow<T>(sum, 2 * traits<T>::weightBits);
+}
+
+template <typename T>
+T quadratic(const T& a, const T& b, const T& c, typename traits<T>::Weight x) {
+    using Accum = typename traits<T>::Accum;
+    const auto w = detail::quadraticWeights(x, traits<T>::weightBits);
+    return narrow<T>(Accum(a) * w[0] + Accum(b) * w[1] + Accum(c) * w[2], traits<T>::weightBits);
+}
+
+template <typename T>
+T biQuadratic(const std::array<T, 9>& v, typename traits<T>::Weight x,
+              typename traits<T>::Weight y) {
+    using Accum = typename traits<T>::Accum;
+    const auto wx = detail::quadraticWeights(x, traits<T>::weightBits);
+    const auto wy = detail::quadraticWeights(y, traits<T>::weightBits);
+    Accum sum(0);
+    for (size_t j = 0; j < 3; ++j) {
+        for (size_t i = 0; i < 3; ++i) sum += Accum(v[i + 3 * j]) * (wx[i] * wy[j]);
+    }
+    return narrow<T>(sum, 2 * traits<T>::weightBits);
+}
+
+template <typename T>
+T barycentric(const std::array<T, 4>& v, typename traits<T>::Weight x,
+              typename traits<T>::Weight y) {
+    using Accum = typename traits<T>::Accum;
+    using Weight = typename traits<T>::Weight;
+    const Weight one = Weight(1) << traits<T>::weightBits;
+    const bool upper = x + y > one;
+    const Accum sum = upper ? Accum(v[3]) * (x + y - one) + Accum(v[1]) * (one - y) +
+                                  Accum(v[2]) * (one - x)
+                            : Accum(v[0]) * (one - x - y) + Accum(v[1]) * x + Accum(v[2]) * y;
+    return narrow<T>(sum, traits<T>::weightBits);
+}
+
+}  // namespace FixedPoint
+
 }  // namespace Interpolation
 }  // namespace TNM067
 }  // namespace inviwo
@@ -0,0 +1,78 @@
+#include <modules/tnm067lab1/utils/layercolormapping.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+#include <inviwo/core/util/imageramutils.h>
+
+#include <type_traits>
+
+namespace inviwo {
+
+namespace detail {
+
+// One task per row, each row is mapped by the vectorised kernel of the table
+template <typename T>
+void mapRows(const DirectColorLUT<T>& lut, const T* inPixels, glm::u8vec4* outPixels, size2_t dims,
+             bool parallel) {
+    auto row = [&](size2_t pos) {
+        const size_t offset = pos.y * dims.x;
+        lut.map(inPixels + offset, outPixels + offset, dims.x);
+    };
+    if (parallel) {
+        util::forEachPixelParallel(size2_t{1, dims.y}, row);
+    } else {
+        for (size_t y = 0; y < dims.y; ++y) row(size2_t{0, y});
+    }
+}
+
+}  // namespace detail
+
+LayerColorMapping::LayerColorMapping() {
+    lut8_.update(map_, range_);
+    lut16_.update(map_, range_);
+}
+
+bool LayerColorMapping::setBaseColors(const std::vector<vec4>& colors) {
+    if (colors == map_.getBaseColors()) return false;
+    map_.setBaseColors(colors);
+    lut8_.update(map_, range_);
+    lut16_.update(map_, range_);
+    return true;
+}
+
+bool LayerColorMapping::setRange(dvec2 range) {
+    if (range == range_) return false;
+    range_ = range;
+    offset_ = static_cast<float>(range.x);
+    scale_ = range.y > range.x ? static_cast<float>(1.0 / (range.y - range.x)) : 0.0f;
+    lut8_.update(map_, range_);
+    lut16_.update(map_, range_);
+    return true;
+}
+
+void LayerColorMapping::map(const LayerRAM& layer, glm::u8vec4* outPixels, bool parallel) const {
+    layer.dispatch<void>([&](const auto inRep) {
+        using T = std::remove_cv_t<std::remove_pointer_t<decltype(inRep->getDataTyped())>>;
+        auto inPixels = inRep->getDataTyped();
+        const size2_t dims = inRep->getDimensions();
+        // 8 and 16 bit images index a table with one entry per value, no conversion to float
+        if constexpr (std::is_same<T, std::uint8_t>::value) {
+            detail::mapRows(lut8_, inPixels, outPixels, dims, parallel);
+        } else if constexpr (std::is_same<T, std::uint16_t>::value) {
+            detail::mapRows(lut16_, inPixels, outPixels, dims, parallel);
+        } else {
+            auto pixel = [&](size2_t pos) {
+                const size_t i = pos.x + pos.y * dims.x;
+                float inPixelVal = util::glm_convert_normalized<float>(inPixels[i]);
+                outPixels[i] = lookup(inPixelVal);
+            };
+            if (parallel) {
+                util::forEachPixelParallel(dims, pixel);
+            } else {
+                for (size_t y = 0; y < dims.y; ++y) {
+                    for (size_t x = 0; x < dims.x; ++x) pixel(size2_t{x, y});
+                }
+            }
+        }
+    });
+}
+
+}  // namespace inviwo
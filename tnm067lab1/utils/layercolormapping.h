@@ -0,0 +1,71 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <modules/tnm067lab1/utils/directcolorlut.h>
+#include <inviwo/core/datastructures/image/layerram.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace inviwo {
+
+/**
+ * \class LayerColorMapping
+ * \brief Maps the scalar values of a layer to u8vec4 colors
+ * 8 and 16 bit layers index an exact DirectColorLUT, other formats are normalized and read the
+ * interpolated lookup table of ScalarToColorMapping. Values are normalized like
+ * util::glm_convert_normalized and the range set by setRange() is stretched over the colors. All
+ * tables are updated by setBaseColors() and setRange(), after that map() only reads them and can
+ * be called from several threads at once.
+ */
+class IVW_MODULE_TNM067LAB1_API LayerColorMapping {
+public:
+    LayerColorMapping();
+
+    /**
+     * Rebuilds the tables if colors differ from the current base colors, returns whether they did
+     */
+    bool setBaseColors(const std::vector<vec4>& colors);
+    /**
+     * Sets the normalized value range mapped to the first and last color, by default [0, 1], the
+     * full range of the data type. The tables are only rebuilt if the range differs, returns
+     * whether it did.
+     */
+    bool setRange(dvec2 range);
+
+    /**
+     * Writes the color of every pixel of layer to outPixels, which has to hold as many pixels.
+     * With parallel set the rows are spread over the inviwo thread pool, otherwise everything
+     * runs on the calling thread.
+     */
+    void map(const LayerRAM& layer, glm::u8vec4* outPixels, bool parallel = true) const;
+
+    /**
+     * Maps count consecutive values. 8 and 16 bit values index the exact tables, float values have
+     * to be normalized already, e.g. by util::glm_convert_normalized.
+     */
+    void mapRow(const std::uint8_t* values, glm::u8vec4* outPixels, size_t count) const {
+        lut8_.map(values, outPixels, count);
+    }
+    void mapRow(const std::uint16_t* values, glm::u8vec4* outPixels, size_t count) const {
+        lut16_.map(values, outPixels, count);
+    }
+    void mapRow(const float* normalized, glm::u8vec4* outPixels, size_t count) const {
+        for (size_t i = 0; i < count; ++i) outPixels[i] = lookup(normalized[i]);
+    }
+
+private:
+    glm::u8vec4 lookup(float normalized) const {
+        return map_.lookupPacked((normalized - offset_) * scale_);
+    }
+
+    ScalarToColorMapping map_;
+    dvec2 range_{0.0, 1.0};
+    float offset_ = 0.0f;  // range_ as the float transform applied before lookup()
+    float scale_ = 1.0f;
+    DirectColorLUT<std::uint8_t> lut8_;
+    DirectColorLUT<std::uint16_t> lut16_;
+};
+
+}  // namespace inviwo
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace inviwo {
+namespace TNM067 {
+
+/**
+ * \class BoundedQueue
+ * \brief Thread safe FIFO queue holding at most capacity elements
+ * push() blocks while the queue is full and pop() while it is empty. After close() push() fails
+ * and pop() returns the remaining elements, then an empty optional.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_{capacity > 0 ? capacity : 1} {}
+
+    /**
+     * Returns false, dropping value, if the queue was closed
+     */
+    bool push(T value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [&]() { return closed_ || items_.size() < capacity_; });
+        if (closed_) return false;
+        items_.push_back(std::move(value));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [&]() { return closed_ || !items_.empty(); });
+        if (items_.empty()) return std::nullopt;
+        std::optional<T> value{std::move(items_.front())};
+        items_.pop_front();
+        notFull_.notify_one();
+        return value;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notFull_.notify_all();
+        notEmpty_.notify_all();
+    }
+
+private:
+    const size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+    std::deque<T> items_;
+    bool closed_ = false;
+};
+
+/**
+ * Runs count items through three overlapping stages: load(i) on one thread, map(loaded) on
+ * mapThreads threads and store(i, mapped) on the calling thread. The stages are connected by
+ * queues of the given capacity, so at most 2 * capacity + mapThreads + 2 items are alive at any
+ * time regardless of count. Items are stored in the order they finish mapping, not in index
+ * order. The first exception thrown by a stage stops the pipeline and is rethrown here once all
+ * threads have finished.
+ */
+template <typename Load, typename Map, typename Store>
+void runPipeline(size_t count, size_t capacity, size_t mapThreads, Load load, Map map,
+                 Store store) {
+    using Loaded = std::decay_t<decltype(load(size_t{0}))>;
+    using Mapped = std::decay_t<decltype(map(std::declval<Loaded>()))>;
+
+    BoundedQueue<std::pair<size_t, Loaded>> loaded(capacity);
+    BoundedQueue<std::pair<size_t, Mapped>> mapped(capacity);
+
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto fail = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+        }
+        loaded.close();
+        mapped.close();
+    };
+
+    std::thread loader([&]() {
+        try {
+            for (size_t i = 0; i < count; ++i) {
+                if (!loaded.push({i, load(i)})) break;
+            }
+        } catch (...) {
+            fail();
+        }
+        loaded.close();
+    });
+
+    mapThreads = mapThreads > 0 ? mapThreads : 1;
+    std::atomic<size_t> runningMappers{mapThreads};
+    std::vector<std::thread> mappers;
+    for (size_t t = 0; t < mapThreads; ++t) {
+        mappers.emplace_back([&]() {
+            try {
+                while (auto item = loaded.pop()) {
+                    if (!mapped.push({item->first, map(std::move(item->second))})) break;
+                }
+            } catch (...) {
+                fail();
+            }
+            // The last mapper to finish tells the store stage that nothing more is coming
+            if (--runningMappers == 0) mapped.close();
+        });
+    }
+
+    try {
+        while (auto item = mapped.pop()) {
+            store(item->first, std::move(item->second));
+        }
+    } catch (...) {
+        fail();
+    }
+
+    loader.join();
+    for (auto& mapper : mappers) mapper.join();
+    if (error) std::rethrow_exception(error);
+}
+
+}  // namespace TNM067
+}  // namespace inviwo
@@ -0,0 +1,832 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/utils/interpolationmethods.h>
+#include <inviwo/core/util/glm.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace inviwo {
+namespace TNM067 {
+namespace Resampling {
+
+enum class Method { PiecewiseConstant, Bilinear, Biquadratic, Barycentric };
+
+/**
+ * Type used to accumulate weighted samples of type T. Vector types are accumulated as floating
+ * point vectors of the same extent so that all channels are weighted together.
+ */
+template <typename T>
+struct accum_type {
+    using type = typename float_type<T>::type;
+};
+template <glm::length_t L, typename T, glm::qualifier Q>
+struct accum_type<glm::vec<L, T, Q>> {
+    using type = glm::vec<L, typename float_type<glm::vec<L, T, Q>>::type, Q>;
+};
+
+/**
+ * Weight and accumulation types used by the resamplers for samples of type T. 8 and 16 bit
+ * unsigned samples, and vectors of them, are resampled in fixed point with integer weights of
+ * weightBits fractional bits, see Interpolation::FixedPoint. Other types use floating point
+ * weights and weightBits is 0.
+ */
+template <typename T, bool = Interpolation::FixedPoint::is_fixed_point<T>::value>
+struct sample_traits {
+    using Weight = typename float_type<T>::type;
+    using Accum = typename accum_type<T>::type;
+    static constexpr int weightBits = 0;
+};
+template <typename T>
+struct sample_traits<T, true> {
+    using Weight = typename Interpolation::FixedPoint::traits<T>::Weight;
+    using Accum = typename Interpolation::FixedPoint::traits<T>::Accum;
+    static constexpr int weightBits = Interpolation::FixedPoint::traits<T>::weightBits;
+};
+
+/**
+ * Number of source samples along one axis that contribute to each output sample
+ */
+constexpr size_t tapCount(Method method) {
+    switch (method) {
+        case Method::PiecewiseConstant:
+            return 1;
+        case Method::Biquadratic:
+            return 3;
+        case Method::Bilinear:
+        case Method::Barycentric:
+        default:
+            return 2;
+    }
+}
+
+/**
+ * Position of output sample outCoord in the source when resizing an axis from inSize to outSize
+ */
+inline double sourceCoordinate(double outCoord, size_t inSize, size_t outSize) {
+    return outCoord * (inSize / (outSize * 1.0));
+}
+
+inline size_t clampIndex(std::ptrdiff_t i, size_t size) {
+    return static_cast<size_t>(
+        std::min(std::max(i, std::ptrdiff_t{0}), static_cast<std::ptrdiff_t>(size) - 1));
+}
+
+/**
+ * Largest number of distinct fractional offsets for which a resize is treated as a fixed ratio
+ */
+constexpr size_t maxPhases = 64;
+
+namespace detail {
+
+/**
+ * Computes the weights of the taps for source coordinate c and returns the index of the first tap.
+ * Integer weights have weightBits fractional bits and sum to exactly one.
+ */
+template <typename F>
+std::ptrdiff_t tapWeights(Method method, double c, int weightBits, F* w) {
+    if constexpr (std::is_integral<F>::value) {
+        namespace fp = Interpolation::FixedPoint::detail;
+        const F one = F(1) << weightBits;
+        switch (method) {
+            case Method::PiecewiseConstant: {
+                w[0] = one;
+                return static_cast<std::ptrdiff_t>(std::round(c));
+            }
+            case Method::Biquadratic: {
+                const F x = fp::toWeight<F>((c - std::floor(c)) / 2, weightBits);
+                const auto q = fp::quadraticWeights(x, weightBits);
+                std::copy(q.begin(), q.end(), w);
+                return static_cast<std::ptrdiff_t>(std::floor(c));
+            }
+            case Method::Bilinear:
+            case Method::Barycentric:
+            default: {
+                const F x = fp::toWeight<F>(c - std::floor(c), weightBits);
+                w[0] = one - x;
+                w[1] = x;
+                return static_cast<std::ptrdiff_t>(std::floor(c));
+            }
+        }
+    } else {
+        switch (method) {
+            case Method::PiecewiseConstant: {
+                w[0] = F(1);
+                return static_cast<std::ptrdiff_t>(std::round(c));
+            }
+            case Method::Biquadratic: {
+                // Same basis as Interpolation::quadratic, the three samples span x in [0, 1]
+                const F x = static_cast<F>((c - std::floor(c)) / 2);
+                w[0] = (F(1) - x) * (F(1) - F(2) * x);
+                w[1] = F(4) * x * (F(1) - x);
+                w[2] = x * (F(2) * x - F(1));
+                return static_cast<std::ptrdiff_t>(std::floor(c));
+            }
+            case Method::Bilinear:
+            case Method::Barycentric:
+            default: {
+                const F x = static_cast<F>(c - std::floor(c));
+                w[0] = F(1) - x;
+                w[1] = x;
+                return static_cast<std::ptrdiff_t>(std::floor(c));
+            }
+        }
+    }
+}
+
+}  // namespace detail
+
+/**
+ * \brief Source indices and weights along one axis of a resize
+ * Output sample i reads the source samples first[i] + k, k = 0..taps-1, weighted by
+ * weights[i * taps + k]. Integer weights F are fixed point with weightBits fractional bits. The
+ * outputs in [interiorBegin, interiorEnd) only read samples inside the source and can be evaluated
+ * without clamping, the ones outside that range must clamp.
+ *
+ * When outSize / inSize reduces to p / q with p <= maxPhases, e.g. 2x, 4x or 3/2, the fractional
+ * source offsets repeat every p outputs while the source index advances by q. The weights are then
+ * only evaluated for those p phases and the source indices are exact integers, no per output
+ * coordinate conversion is done.
+ */
+template <typename F>
+struct AxisTaps {
+    AxisTaps(Method method, size_t inSize, size_t outSize, int weightBits = 0);
+
+    size_t taps;
+    int weightBits;
+    size_t size;
+    size_t phases;  // period of the weights, equals size unless the ratio is fixed
+    size_t interiorBegin;
+    size_t interiorEnd;
+    std::vector<std::ptrdiff_t> first;
+    std::vector<F> weights;
+};
+
+template <typename F>
+AxisTaps<F>::AxisTaps(Method method, size_t inSize, size_t outSize, int weightBits)
+    : taps{tapCount(method)}
+    , weightBits{weightBits}
+    , size{outSize}
+    , phases{outSize}
+    , interiorBegin{0}
+    , interiorEnd{0}
+    , first(outSize)
+    , weights(outSize * taps) {
+
+    const size_t gcd = std::gcd(inSize, outSize);
+    if (gcd != 0 && outSize / gcd <= maxPhases) {
+        // Output i = b * p + k maps to the source coordinate b * q + k * q / p
+        const size_t p = outSize / gcd;
+        const size_t q = inSize / gcd;
+        phases = p;
+
+        std::vector<std::ptrdiff_t> phaseFirst(p);
+        std::vector<F> phaseWeights(p * taps);
+        for (size_t k = 0; k < p; ++k) {
+            phaseFirst[k] = detail::tapWeights(method, static_cast<double>(k * q) / p, weightBits,
+                                               &phaseWeights[k * taps]);
+        }
+        for (size_t i = 0, b = 0; i < outSize; i += p, b += q) {
+            for (size_t k = 0; k < p && i + k < outSize; ++k) {
+                first[i + k] = static_cast<std::ptrdiff_t>(b) + phaseFirst[k];
+                std::copy_n(&phaseWeights[k * taps], taps, &weights[(i + k) * taps]);
+            }
+        }
+    } else {
+        for (size_t i = 0; i < outSize; ++i) {
+            const double c = sourceCoordinate(static_cast<double>(i), inSize, outSize);
+            first[i] = detail::tapWeights(method, c, weightBits, &weights[i * taps]);
+        }
+    }
+
+    // first is non-decreasing, so the outputs that need no clamping form a single range
+    const auto lastFirst = static_cast<std::ptrdiff_t>(inSize) - static_cast<std::ptrdiff_t>(taps);
+    auto inside = [&](size_t i) { return first[i] >= 0 && first[i] <= lastFirst; };
+    while (interiorBegin < outSize && !inside(interiorBegin)) ++interiorBegin;
+    interiorEnd = interiorBegin;
+    while (interiorEnd < outSize && inside(interiorEnd)) ++interiorEnd;
+}
+
+namespace detail {
+
+/**
+ * The part of the outputs [begin, end) that needs no clamping
+ */
+template <typename F>
+std::pair<size_t, size_t> interiorRange(const AxisTaps<F>& axis, size_t begin, size_t end) {
+    const size_t interiorBegin = std::min(std::max(axis.interiorBegin, begin), end);
+    const size_t interiorEnd = std::min(std::max(axis.interiorEnd, interiorBegin), end);
+    return {interiorBegin, interiorEnd};
+}
+
+/**
+ * Calls border(i) for the outputs in [begin, end) that need clamping and interior(i) for the rest
+ */
+template <typename F, typename Border, typename Interior>
+void forEachTap(const AxisTaps<F>& axis, size_t begin, size_t end, Border border,
+                Interior interior) {
+    const auto [interiorBegin, interiorEnd] = interiorRange(axis, begin, end);
+    for (size_t i = begin; i < interiorBegin; ++i) border(i);
+    for (size_t i = interiorBegin; i < interiorEnd; ++i) interior(i);
+    for (size_t i = interiorEnd; i < end; ++i) border(i);
+}
+
+/**
+ * Converts a weighted sum with fractionBits fractional bits to a sample of type T, fixed point
+ * sums are rounded and saturated
+ */
+template <typename T, typename A>
+T toSample(const A& sum, int fractionBits) {
+    if constexpr (Interpolation::FixedPoint::is_fixed_point<T>::value) {
+        return Interpolation::FixedPoint::narrow<T>(sum, fractionBits);
+    } else {
+        return static_cast<T>(sum);
+    }
+}
+
+template <typename T, typename F>
+void nearestRow(const T* srcRow, size_t srcWidth, const AxisTaps<F>& cols, size_t colBegin,
+                size_t colEnd, T* dstRow) {
+    forEachTap(
+        cols, colBegin, colEnd,
+        [&](size_t x) { dstRow[x] = srcRow[clampIndex(cols.first[x], srcWidth)]; },
+        [&](size_t x) { dstRow[x] = srcRow[cols.first[x]]; });
+}
+
+/**
+ * Filters one source row with N taps to the output columns [colBegin, colEnd), tmpRow[0]
+ * corresponds to column colBegin
+ */
+template <size_t N, typename T, typename A, typename F>
+void filterRow(const T* srcRow, size_t srcWidth, const AxisTaps<F>& cols, size_t colBegin,
+               size_t colEnd, A* tmpRow) {
+    forEachTap(
+        cols, colBegin, colEnd,
+        [&](size_t x) {
+            A sum(0);
+            for (std::ptrdiff_t k = 0; k < static_cast<std::ptrdiff_t>(N); ++k) {
+                const T s = srcRow[clampIndex(cols.first[x] + k, srcWidth)];
+                sum += cols.weights[x * N + k] * static_cast<A>(s);
+            }
+            tmpRow[x - colBegin] = sum;
+        },
+        [&](size_t x) {
+            const T* s = srcRow + cols.first[x];
+            const F* w = &cols.weights[x * N];
+            A sum(0);
+            for (size_t k = 0; k < N; ++k) sum += w[k] * static_cast<A>(s[k]);
+            tmpRow[x - colBegin] = sum;
+        });
+}
+
+/**
+ * Weighted sum of N horizontally filtered rows, a plain loop over the columns. The sums have
+ * fractionBits fractional bits, see toSample().
+ */
+template <size_t N, typename T, typename A, typename F>
+void combineRows(const std::array<const A*, N>& r, const F* weights, int fractionBits,
+                 size_t width, T* dstRow) {
+    std::array<F, N> w;
+    std::copy_n(weights, N, w.begin());
+    for (size_t x = 0; x < width; ++x) {
+        A sum = w[0] * r[0][x];
+        for (size_t k = 1; k < N; ++k) sum += w[k] * r[k][x];
+        dstRow[x] = toSample<T>(sum, fractionBits);
+    }
+}
+
+/**
+ * Rounds a fixed point sum to bits fewer fractional bits, floating point sums are returned as is
+ */
+template <typename A>
+A roundShift(const A& sum, int bits) {
+    if constexpr (std::is_integral<A>::value) {
+        return bits == 0 ? sum : (sum + (A(1) << (bits - 1))) >> bits;
+    } else if constexpr (std::is_floating_point<A>::value) {
+        return sum;
+    } else {
+        A res;
+        for (glm::length_t i = 0; i < A::length(); ++i) res[i] = roundShift(sum[i], bits);
+        return res;
+    }
+}
+
+/**
+ * Like combineRows but keeps the weighted sums as intermediate values. Fixed point sums are
+ * rounded back to weightBits fractional bits so that a further pass can not overflow.
+ */
+template <size_t N, typename A, typename F>
+void combineIntermediateRows(const std::array<const A*, N>& r, const F* weights, int weightBits,
+                             size_t width, A* dstRow) {
+    std::array<F, N> w;
+    std::copy_n(weights, N, w.begin());
+    for (size_t x = 0; x < width; ++x) {
+        A sum = w[0] * r[0][x];
+        for (size_t k = 1; k < N; ++k) sum += w[k] * r[k][x];
+        dstRow[x] = roundShift(sum, weightBits);
+    }
+}
+
+/**
+ * Number of outputs gathered into one batch for the batched interpolation functions
+ */
+constexpr size_t batchSize = 64;
+
+/**
+ * The barycentric interpolation is not separable, it is evaluated directly on the 2x2
+ * neighbourhood of the source rows row0 and row1 using the bilinear taps of the columns. The
+ * interior columns are gathered into structure of arrays batches for the batched
+ * Interpolation::barycentric.
+ */
+template <typename T, typename A, typename F>
+void barycentricRow(const T* row0, const T* row1, size_t srcWidth, F fy, const AxisTaps<F>& cols,
+                    size_t colBegin, size_t colEnd, T* dstRow) {
+    if constexpr (Interpolation::FixedPoint::is_fixed_point<T>::value) {
+        namespace fp = Interpolation::FixedPoint;
+        forEachTap(
+            cols, colBegin, colEnd,
+            [&](size_t x) {
+                const size_t x0 = clampIndex(cols.first[x], srcWidth);
+                const size_t x1 = clampIndex(cols.first[x] + 1, srcWidth);
+                const std::array<T, 4> corners{row0[x0], row0[x1], row1[x0], row1[x1]};
+                dstRow[x] = fp::barycentric(corners, cols.weights[x * 2 + 1], fy);
+            },
+            [&](size_t x) {
+                const auto x0 = cols.first[x];
+                dstRow[x] = fp::barycentric(
+                    std::array<T, 4>{row0[x0], row0[x0 + 1], row1[x0], row1[x0 + 1]},
+                    cols.weights[x * 2 + 1], fy);
+            });
+        return;
+    }
+
+    auto border = [&](size_t x) {
+        const size_t x0 = clampIndex(cols.first[x], srcWidth);
+        const size_t x1 = clampIndex(cols.first[x] + 1, srcWidth);
+        const std::array<A, 4> v{static_cast<A>(row0[x0]), static_cast<A>(row0[x1]),
+                                 static_cast<A>(row1[x0]), static_cast<A>(row1[x1])};
+        dstRow[x] = static_cast<T>(Interpolation::barycentric(v, cols.weights[x * 2 + 1], fy));
+    };
+    const auto [interiorBegin, interiorEnd] = interiorRange(cols, colBegin, colEnd);
+
+    for (size_t x = colBegin; x < interiorBegin; ++x) border(x);
+
+    std::array<std::array<A, batchSize>, 4> v;
+    std::array<F, batchSize> fx;
+    std::array<F, batchSize> fys;
+    std::array<A, batchSize> res;
+    fys.fill(fy);
+    for (size_t x = interiorBegin; x < interiorEnd; x += batchSize) {
+        const size_t n = std::min(batchSize, interiorEnd - x);
+        for (size_t i = 0; i < n; ++i) {
+            const auto x0 = cols.first[x + i];
+            v[0][i] = static_cast<A>(row0[x0]);
+            v[1][i] = static_cast<A>(row0[x0 + 1]);
+            v[2][i] = static_cast<A>(row1[x0]);
+            v[3][i] = static_cast<A>(row1[x0 + 1]);
+            fx[i] = cols.weights[(x + i) * 2 + 1];
+        }
+        Interpolation::barycentric<A, F>({v[0].data(), v[1].data(), v[2].data(), v[3].data()},
+                                         fx.data(), fys.data(), res.data(), n);
+        for (size_t i = 0; i < n; ++i) dstRow[x + i] = static_cast<T>(res[i]);
+    }
+
+    for (size_t x = interiorEnd; x < colEnd; ++x) border(x);
+}
+
+template <typename T, typename F>
+void resampleNearest(const T* src, size2_t srcSize, T* dst, const AxisTaps<F>& cols,
+                     const AxisTaps<F>& rows, size2_t begin, size2_t end) {
+    for (size_t y = begin.y; y < end.y; ++y) {
+        const T* srcRow = src + clampIndex(rows.first[y], srcSize.y) * srcSize.x;
+        nearestRow(srcRow, srcSize.x, cols, begin.x, end.x, dst + y * cols.size);
+    }
+}
+
+/**
+ * Horizontal pass with N taps, filters the source rows [rowBegin, rowEnd) to the output columns
+ * [colBegin, colEnd). Row y - rowBegin of tmp holds the result for source row y.
+ */
+template <size_t N, typename T, typename A, typename F>
+void filterRows(const T* src, size2_t srcSize, size_t rowBegin, size_t rowEnd,
+                const AxisTaps<F>& cols, size_t colBegin, size_t colEnd, A* tmp) {
+    const size_t width = colEnd - colBegin;
+    for (size_t y = rowBegin; y < rowEnd; ++y) {
+        filterRow<N>(src + y * srcSize.x, srcSize.x, cols, colBegin, colEnd,
+                     tmp + (y - rowBegin) * width);
+    }
+}
+
+/**
+ * Vertical pass with N taps, combines the horizontally filtered rows in tmp into the output rows
+ * [rowBegin, rowEnd) and columns [colBegin, colEnd). The clamping of row indices is done once per
+ * output row.
+ */
+template <size_t N, typename T, typename A, typename F>
+void filterColumns(const A* tmp, size_t tmpRowBegin, size_t srcRows, const AxisTaps<F>& rows,
+                   int fractionBits, size_t rowBegin, size_t rowEnd, size_t colBegin,
+                   size_t colEnd, T* dst, size_t dstWidth) {
+    const size_t width = colEnd - colBegin;
+    std::array<const A*, N> r;
+    for (size_t y = rowBegin; y < rowEnd; ++y) {
+        for (std::ptrdiff_t k = 0; k < static_cast<std::ptrdiff_t>(N); ++k) {
+            r[k] = tmp + (clampIndex(rows.first[y] + k, srcRows) - tmpRowBegin) * width;
+        }
+        combineRows<N>(r, &rows.weights[y * N], fractionBits, width, dst + y * dstWidth + colBegin);
+    }
+}
+
+template <typename T, typename A, typename F>
+void resampleBarycentric(const T* src, size2_t srcSize, T* dst, const AxisTaps<F>& cols,
+                         const AxisTaps<F>& rows, size2_t begin, size2_t end) {
+    for (size_t y = begin.y; y < end.y; ++y) {
+        const T* row0 = src + clampIndex(rows.first[y], srcSize.y) * srcSize.x;
+        const T* row1 = src + clampIndex(rows.first[y] + 1, srcSize.y) * srcSize.x;
+        barycentricRow<T, A>(row0, row1, srcSize.x, rows.weights[y * 2 + 1], cols, begin.x, end.x,
+                             dst + y * cols.size);
+    }
+}
+
+}  // namespace detail
+
+/**
+ * Output tile size used when resampling in parallel. The horizontally filtered source rows of one
+ * tile and the tile itself stay well within the L2 cache.
+ */
+constexpr size_t defaultTileWidth = 256;
+constexpr size_t defaultTileHeight = 64;
+
+/**
+ * \class Resampler
+ * \brief Resamples images of size srcSize into images of size dstSize using method M
+ * The method is a template parameter so that every method gets its own kernel with a fixed number
+ * of taps, use dispatch() to select it once per image.
+ *
+ * The output is split into tiles that can be evaluated independently and in any order, every
+ * output pixel is computed the same way regardless of tiling so the result does not depend on how
+ * the tiles are distributed over threads. Separable methods are evaluated as a horizontal pass over
+ * the source rows a tile needs followed by a vertical pass. The source indices and weights are
+ * computed once per axis and only the samples at the image borders are clamped.
+ */
+template <typename T, Method M>
+class Resampler {
+public:
+    using F = typename sample_traits<T>::Weight;
+    using A = typename sample_traits<T>::Accum;
+    static constexpr int weightBits = sample_traits<T>::weightBits;
+    static constexpr size_t taps = tapCount(M);
+
+    Resampler(size2_t srcSize, size2_t dstSize,
+              size2_t tileSize = size2_t(defaultTileWidth, defaultTileHeight))
+        : srcSize_{srcSize}
+        , dstSize_{dstSize}
+        , tileSize_{tileSize}
+        , cols_{M, srcSize.x, dstSize.x, weightBits}
+        , rows_{M, srcSize.y, dstSize.y, weightBits} {}
+
+    size2_t getTileCount() const {
+        return size2_t((dstSize_.x + tileSize_.x - 1) / tileSize_.x,
+                       (dstSize_.y + tileSize_.y - 1) / tileSize_.y);
+    }
+
+    /**
+     * Resamples the output tile with index tile, see getTileCount()
+     */
+    void resampleTile(const T* src, T* dst, size2_t tile) const {
+        const size2_t begin(tile.x * tileSize_.x, tile.y * tileSize_.y);
+        const size2_t end(std::min(begin.x + tileSize_.x, dstSize_.x),
+                          std::min(begin.y + tileSize_.y, dstSize_.y));
+        if (begin.x >= end.x || begin.y >= end.y) return;
+
+        if constexpr (M == Method::PiecewiseConstant) {
+            detail::resampleNearest(src, srcSize_, dst, cols_, rows_, begin, end);
+        } else if constexpr (M == Method::Barycentric) {
+            detail::resampleBarycentric<T, A>(src, srcSize_, dst, cols_, rows_, begin, end);
+        } else {
+            const auto rowBegin = clampIndex(rows_.first[begin.y], srcSize_.y);
+            const auto lastTap = rows_.first[end.y - 1] + static_cast<std::ptrdiff_t>(taps) - 1;
+            const auto rowEnd = clampIndex(lastTap, srcSize_.y) + 1;
+            std::vector<A> tmp((end.x - begin.x) * (rowEnd - rowBegin));
+            detail::filterRows<taps>(src, srcSize_, rowBegin, rowEnd, cols_, begin.x, end.x,
+                                     tmp.data());
+            detail::filterColumns<taps>(tmp.data(), rowBegin, srcSize_.y, rows_, 2 * weightBits,
+                                        begin.y, end.y, begin.x, end.x, dst, dstSize_.x);
+        }
+    }
+
+    void resample(const T* src, T* dst) const {
+        const auto tiles = getTileCount();
+        for (size_t y = 0; y < tiles.y; ++y) {
+            for (size_t x = 0; x < tiles.x; ++x) resampleTile(src, dst, size2_t(x, y));
+        }
+    }
+
+private:
+    size2_t srcSize_;
+    size2_t dstSize_;
+    size2_t tileSize_;
+    AxisTaps<F> cols_;
+    AxisTaps<F> rows_;
+};
+
+/**
+ * \class StripResampler
+ * \brief Resamples images that do not fit in memory, one horizontal strip at a time
+ * The source is read one row at a time in increasing order through a sliding window of
+ * tapCount(M) rows, i.e. 2 rows for bilinear and barycentric and 3 for biquadratic. The output is
+ * handed to a sink in strips of stripHeight rows. Peak memory is bounded by the window and the
+ * strip, independent of the image height. The result equals the one of Resampler.
+ */
+template <typename T, Method M>
+class StripResampler {
+public:
+    using F = typename sample_traits<T>::Weight;
+    using A = typename sample_traits<T>::Accum;
+    static constexpr int weightBits = sample_traits<T>::weightBits;
+    static constexpr size_t taps = tapCount(M);
+    static constexpr bool separable = M == Method::Bilinear || M == Method::Biquadratic;
+
+    StripResampler(size2_t srcSize, size2_t dstSize, size_t stripHeight)
+        : srcSize_{srcSize}
+        , dstSize_{dstSize}
+        , stripHeight_{std::max(stripHeight, size_t{1})}
+        , cols_{M, srcSize.x, dstSize.x, weightBits}
+        , rows_{M, srcSize.y, dstSize.y, weightBits} {}
+
+    /**
+     * @param source callable as const T*(size_t y), returns source row y. The pointer only has to
+     *        stay valid until the next call. Rows are requested in increasing order.
+     * @param sink callable as void(const T* pixels, size_t firstRow, size_t rowCount), receives
+     *        consecutive strips of output rows. A sink that returns bool instead stops the run by
+     *        returning false, no more rows are read or resampled after that.
+     * @return false if the sink stopped the run
+     */
+    template <typename Source, typename Sink>
+    bool run(Source source, Sink sink) const {
+        // Separable methods keep the horizontally filtered rows, the others the source rows
+        using Row = typename std::conditional<separable, A, T>::type;
+        const size_t rowWidth = separable ? dstSize_.x : srcSize_.x;
+
+        std::vector<Row> window(taps * rowWidth);
+        std::array<size_t, taps> windowRow;
+        windowRow.fill(srcSize_.y);
+        auto fetch = [&](size_t y) -> const Row* {
+            const size_t slot = y % taps;
+            Row* row = &window[slot * rowWidth];
+            if (windowRow[slot] != y) {
+                const T* srcRow = source(y);
+                if constexpr (separable) {
+                    detail::filterRow<taps>(srcRow, srcSize_.x, cols_, 0, dstSize_.x, row);
+                } else {
+                    std::copy_n(srcRow, srcSize_.x, row);
+                }
+                windowRow[slot] = y;
+            }
+            return row;
+        };
+
+        std::vector<T> strip(stripHeight_ * dstSize_.x);
+        for (size_t firstRow = 0; firstRow < dstSize_.y; firstRow += stripHeight_) {
+            const size_t rowCount = std::min(stripHeight_, dstSize_.y - firstRow);
+            for (size_t j = 0; j < rowCount; ++j) {
+                const size_t y = firstRow + j;
+                T* dstRow = &strip[j * dstSize_.x];
+                if constexpr (M == Method::PiecewiseConstant) {
+                    const T* row = fetch(clampIndex(rows_.first[y], srcSize_.y));
+                    detail::nearestRow(row, srcSize_.x, cols_, 0, dstSize_.x, dstRow);
+                } else if constexpr (M == Method::Barycentric) {
+                    const T* row0 = fetch(clampIndex(rows_.first[y], srcSize_.y));
+                    const T* row1 = fetch(clampIndex(rows_.first[y] + 1, srcSize_.y));
+                    detail::barycentricRow<T, A>(row0, row1, srcSize_.x, rows_.weights[y * 2 + 1],
+                                                 cols_, 0, dstSize_.x, dstRow);
+                } else {
+                    std::array<const A*, taps> r;
+                    for (std::ptrdiff_t k = 0; k < static_cast<std::ptrdiff_t>(taps); ++k) {
+                        r[k] = fetch(clampIndex(rows_.first[y] + k, srcSize_.y));
+                    }
+                    detail::combineRows<taps>(r, &rows_.weights[y * taps], 2 * weightBits,
+                                              dstSize_.x, dstRow);
+                }
+            }
+            const T* pixels = strip.data();
+            if constexpr (std::is_same<decltype(sink(pixels, firstRow, rowCount)), bool>::value) {
+                if (!sink(pixels, firstRow, rowCount)) return false;
+            } else {
+                sink(pixels, firstRow, rowCount);
+            }
+        }
+        return true;
+    }
+
+private:
+    size2_t srcSize_;
+    size2_t dstSize_;
+    size_t stripHeight_;
+    AxisTaps<F> cols_;
+    AxisTaps<F> rows_;
+};
+
+/**
+ * Output brick size used when resampling volumes in parallel
+ */
+constexpr size_t defaultBrickSize = 32;
+
+/**
+ * \class VolumeResampler
+ * \brief Resamples volumes of size srcSize into volumes of size dstSize using method M
+ * The 3D counterpart of Resampler. PiecewiseConstant picks the nearest voxel, Bilinear and
+ * Biquadratic along every axis give the same values as Interpolation::trilinear and
+ * Interpolation::triQuadratic, which are only the per voxel reference for this separable version
+ * and are not called by it. Barycentric is only defined in 2D.
+ *
+ * The output is split into bricks that can be evaluated independently and in any order. Each
+ * brick filters the source voxels it needs along x, then along y and finally along z, so every
+ * source voxel is read once per brick instead of once per tap.
+ */
+template <typename T, Method M>
+class VolumeResampler {
+public:
+    static_assert(M != Method::Barycentric, "Barycentric interpolation is only defined in 2D");
+
+    using F = typename sample_traits<T>::Weight;
+    using A = typename sample_traits<T>::Accum;
+    static constexpr int weightBits = sample_traits<T>::weightBits;
+    static constexpr size_t taps = tapCount(M);
+
+    VolumeResampler(size3_t srcSize, size3_t dstSize, size3_t brickSize = size3_t(defaultBrickSize))
+        : srcSize_{srcSize}
+        , dstSize_{dstSize}
+        , brickSize_{brickSize}
+        , cols_{M, srcSize.x, dstSize.x, weightBits}
+        , rows_{M, srcSize.y, dstSize.y, weightBits}
+        , slices_{M, srcSize.z, dstSize.z, weightBits} {}
+
+    size3_t getBrickCount() const { return (dstSize_ + brickSize_ - size_t(1)) / brickSize_; }
+
+    /**
+     * Resamples the output brick with index brick, see getBrickCount()
+     */
+    void resampleBrick(const T* src, T* dst, size3_t brick) const {
+        const size3_t begin = brick * brickSize_;
+        const size3_t end = glm::min(begin + brickSize_, dstSize_);
+        if (begin.x >= end.x || begin.y >= end.y || begin.z >= end.z) return;
+
+        auto srcRow = [&](size_t y, size_t z) { return src + (z * srcSize_.y + y) * srcSize_.x; };
+        auto dstRow = [&](size_t y, size_t z) { return dst + (z * dstSize_.y + y) * dstSize_.x; };
+
+        if constexpr (M == Method::PiecewiseConstant) {
+            for (size_t z = begin.z; z < end.z; ++z) {
+                const size_t sz = clampIndex(slices_.first[z], srcSize_.z);
+                for (size_t y = begin.y; y < end.y; ++y) {
+                    const size_t sy = clampIndex(rows_.first[y], srcSize_.y);
+                    detail::nearestRow(srcRow(sy, sz), srcSize_.x, cols_, begin.x, end.x,
+                                       dstRow(y, z));
+                }
+            }
+        } else {
+            const auto tapEnd = [&](const AxisTaps<F>& axis, size_t last, size_t size) {
+                const auto lastTap = axis.first[last] + static_cast<std::ptrdiff_t>(taps) - 1;
+                return clampIndex(lastTap, size) + 1;
+            };
+            const size_t rowBegin = clampIndex(rows_.first[begin.y], srcSize_.y);
+            const size_t rowEnd = tapEnd(rows_, end.y - 1, srcSize_.y);
+            const size_t sliceBegin = clampIndex(slices_.first[begin.z], srcSize_.z);
+            const size_t sliceEnd = tapEnd(slices_, end.z - 1, srcSize_.z);
+
+            const size_t width = end.x - begin.x;
+            const size_t height = end.y - begin.y;
+            const size_t srcRows = rowEnd - rowBegin;
+
+            // Along x, for every source row the brick reads
+            std::vector<A> xPass(width * srcRows * (sliceEnd - sliceBegin));
+            for (size_t z = sliceBegin; z < sliceEnd; ++z) {
+                detail::filterRows<taps>(srcRow(0, z), size2_t(srcSize_.x, srcSize_.y), rowBegin,
+                                         rowEnd, cols_, begin.x, end.x,
+                                         &xPass[(z - sliceBegin) * srcRows * width]);
+            }
+
+            // Along y, for every source slice the brick reads
+            std::vector<A> yPass(width * height * (sliceEnd - sliceBegin));
+            std::array<const A*, taps> r;
+            for (size_t z = sliceBegin; z < sliceEnd; ++z) {
+                const A* slice = &xPass[(z - sliceBegin) * srcRows * width];
+                for (size_t y = begin.y; y < end.y; ++y) {
+                    for (std::ptrdiff_t k = 0; k < static_cast<std::ptrdiff_t>(taps); ++k) {
+                        const size_t sy = clampIndex(rows_.first[y] + k, srcSize_.y);
+                        r[k] = slice + (sy - rowBegin) * width;
+                    }
+                    A* out = &yPass[((z - sliceBegin) * height + (y - begin.y)) * width];
+                    detail::combineIntermediateRows<taps>(r, &rows_.weights[y * taps], weightBits,
+                                                          width, out);
+                }
+            }
+
+            // Along z into the output
+            for (size_t z = begin.z; z < end.z; ++z) {
+                for (size_t y = begin.y; y < end.y; ++y) {
+                    for (std::ptrdiff_t k = 0; k < static_cast<std::ptrdiff_t>(taps); ++k) {
+                        const size_t sz = clampIndex(slices_.first[z] + k, srcSize_.z);
+                        r[k] = &yPass[((sz - sliceBegin) * height + (y - begin.y)) * width];
+                    }
+                    detail::combineRows<taps>(r, &slices_.weights[z * taps], 2 * weightBits, width,
+                                              dstRow(y, z) + begin.x);
+                }
+            }
+        }
+    }
+
+    void resample(const T* src, T* dst) const {
+        const auto bricks = getBrickCount();
+        for (size_t z = 0; z < bricks.z; ++z) {
+            for (size_t y = 0; y < bricks.y; ++y) {
+                for (size_t x = 0; x < bricks.x; ++x) resampleBrick(src, dst, size3_t(x, y, z));
+            }
+        }
+    }
+
+private:
+    size3_t srcSize_;
+    size3_t dstSize_;
+    size3_t brickSize_;
+    AxisTaps<F> cols_;
+    AxisTaps<F> rows_;
+    AxisTaps<F> slices_;
+};
+
+/**
+ * Calls callable with std::integral_constant<Method, method>, i.e. converts the run time method
+ * into a compile time one. The callable is instantiated for every method.
+ */
+template <typename Callable>
+decltype(auto) dispatch(Method method, Callable&& callable) {
+    switch (method) {
+        case Method::PiecewiseConstant:
+            return callable(std::integral_constant<Method, Method::PiecewiseConstant>{});
+        case Method::Bilinear:
+            return callable(std::integral_constant<Method, Method::Bilinear>{});
+        case Method::Biquadratic:
+            return callable(std::integral_constant<Method, Method::Biquadratic>{});
+        case Method::Barycentric:
+        default:
+            return callable(std::integral_constant<Method, Method::Barycentric>{});
+    }
+}
+
+/**
+ * Resamples the image src of size srcSize into dst of size dstSize on the calling thread
+ */
+template <typename T>
+void resample(Method method, const T* src, size2_t srcSize, T* dst, size2_t dstSize) {
+    dispatch(method, [&](auto m) {
+        Resampler<T, decltype(m)::value>(srcSize, dstSize).resample(src, dst);
+    });
+}
+
+/**
+ * Size of the next level of an image pyramid, half of size rounded down but at least one pixel
+ */
+inline size2_t halfSize(size2_t size) { return glm::max(size / size_t(2), size2_t(1)); }
+
+namespace detail {
+template <typename T>
+struct component {
+    using type = T;
+};
+template <glm::length_t L, typename T, glm::qualifier Q>
+struct component<glm::vec<L, T, Q>> {
+    using type = T;
+};
+}  // namespace detail
+
+/**
+ * Mean of four samples, the 2x2 box filter of an image pyramid. 8 and 16 bit samples are averaged
+ * in fixed point as (a + b + c + d + 2) / 4, other integer samples are rounded to the nearest
+ * value as well.
+ */
+template <typename T>
+T average4(const T& a, const T& b, const T& c, const T& d) {
+    namespace fp = Interpolation::FixedPoint;
+    if constexpr (fp::is_fixed_point<T>::value) {
+        using Accum = typename fp::traits<T>::Accum;
+        return fp::narrow<T>(Accum(a) + Accum(b) + Accum(c) + Accum(d), 2);
+    } else {
+        using A = typename accum_type<T>::type;
+        const A mean = (A(a) + A(b) + A(c) + A(d)) / A(4);
+        if constexpr (std::is_integral<typename detail::component<T>::type>::value) {
+            return static_cast<T>(glm::round(mean));
+        } else {
+            return static_cast<T>(mean);
+        }
+    }
+}
+
+}  // namespace Resampling
+}  // namespace TNM067
+}  // namespace inviwo
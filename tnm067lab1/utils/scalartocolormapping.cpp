@@ -1,9 +1,37 @@
 #include <modules/tnm067lab1/utils/scalartocolormapping.h>
 
+#include <cmath>
+
 namespace inviwo {
 
-void ScalarToColorMapping::clearColors() { baseColors_.clear(); }
-void ScalarToColorMapping::addBaseColors(vec4 color) { baseColors_.push_back(color); }
+ScalarToColorMapping::ScalarToColorMapping()
+    : baseColors_{}, lut_(lutSize), packedLut_(lutSize) {}
+
+ScalarToColorMapping::ScalarToColorMapping(const ScalarToColorMapping& other)
+    : baseColors_{other.baseColors_}, lut_(lutSize), packedLut_(lutSize) {}
+
+ScalarToColorMapping& ScalarToColorMapping::operator=(const ScalarToColorMapping& other) {
+    if (this != &other) {
+        baseColors_ = other.baseColors_;
+        lutStale_ = true;
+    }
+    return *this;
+}
+
+void ScalarToColorMapping::clearColors() {
+    baseColors_.clear();
+    lutStale_ = true;
+}
+void ScalarToColorMapping::addBaseColors(vec4 color) {
+    baseColors_.push_back(color);
+    lutStale_ = true;
+}
+
+void ScalarToColorMapping::setBaseColors(const std::vector<vec4>& colors) {
+    if (colors == baseColors_) return;
+    baseColors_ = colors;
+    lutStale_ = true;
+}
 
 vec4 ScalarToColorMapping::sample(float t) const {
     if (baseColors_.size() == 0) return vec4(t);
@@ -13,15 +41,26 @@ vec4 ScalarToColorMapping::sample(float t) const {
 
     // TODO: use t to select which two base colors to interpolate in-between
     float intervalSize = 1.0f / (baseColors_.size() - 1.0f);
-    size_t firstIdx = std::floorf(t / intervalSize);
+    size_t firstIdx = std::floor(t / intervalSize);
 
     vec4 firstColor = baseColors_[firstIdx];
     vec4 secondColor = baseColors_[firstIdx + 1];
 
     // TODO: Interpolate colors in baseColors_ and set dummy color to result
     float intervalWeight = (t / intervalSize);
-    intervalWeight = intervalWeight - std::floorf(intervalWeight);
+    intervalWeight = intervalWeight - std::floor(intervalWeight);
     return (firstColor * (1.0f - intervalWeight)) + (secondColor * intervalWeight);
 }
 
+void ScalarToColorMapping::updateLUT() const {
+    // Threads that look up at the same time wait for the first one to fill the tables
+    std::lock_guard<std::mutex> lock(lutMutex_);
+    if (!lutStale_.load(std::memory_order_relaxed)) return;
+    for (size_t i = 0; i < lutSize; ++i) {
+        lut_[i] = sample(static_cast<float>(i) / (lutSize - 1));
+        packedLut_[i] = u8vec4(lut_[i] * 255.f);
+    }
+    lutStale_.store(false, std::memory_order_release);
+}
+
 }  // namespace inviwo
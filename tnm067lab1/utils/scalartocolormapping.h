@@ -2,6 +2,8 @@
 
 #include <modules/tnm067lab1/tnm067lab1moduledefine.h>
 
+#include <atomic>
+#include <mutex>
 #include <vector>
 #include <inviwo/core/util/glmvec.h>
 
@@ -13,17 +15,65 @@ namespace inviwo {
 /**
  * \class ScalarToColorMapping
  * \brief Scalar to color mapping
- * Colors are interpolated from the baseColors_.
+ * Colors are interpolated from the baseColors_. sample() evaluates the interpolation, lookup() and
+ * lookupPacked() read a lookup table of lutSize samples. Changing the base colors only marks the
+ * table as stale, it is rebuilt once by the first lookup after that, so adding colors one at a
+ * time costs no more than setting them all at once. Use the lookups when mapping many values,
+ * e.g. once per pixel. Lookups may be called from several threads at once.
  */
 class IVW_MODULE_TNM067LAB1_API ScalarToColorMapping {
 public:
-    ScalarToColorMapping() = default;
+    static constexpr size_t lutSize = 4096;
+
+    ScalarToColorMapping();
+    // Copies the base colors, the copy builds its own table when it is first used
+    ScalarToColorMapping(const ScalarToColorMapping& other);
+    ScalarToColorMapping& operator=(const ScalarToColorMapping& other);
+
     void addBaseColors(vec4 color);
     void clearColors();
+    /**
+     * Replaces the base colors, the lookup table is only marked as stale if they differ from the
+     * current ones
+     */
+    void setBaseColors(const std::vector<vec4>& colors);
+    const std::vector<vec4>& getBaseColors() const { return baseColors_; }
+
     vec4 sample(float t) const;
 
+    /**
+     * Nearest entry of the lookup table, differs from sample(t) by at most the change of color
+     * over 1 / (2 * (lutSize - 1))
+     */
+    vec4 lookup(float t) const {
+        ensureLUT();
+        return lut_[lutIndex(t)];
+    }
+    /**
+     * Like lookup() but converted to 8 bits per channel the same way as u8vec4(lookup(t) * 255.f)
+     */
+    u8vec4 lookupPacked(float t) const {
+        ensureLUT();
+        return packedLut_[lutIndex(t)];
+    }
+
 private:
+    static size_t lutIndex(float t) {
+        // Written so that NaN maps to the first entry
+        const float clamped = t > 0.0f ? (t < 1.0f ? t : 1.0f) : 0.0f;
+        return static_cast<size_t>(clamped * (lutSize - 1) + 0.5f);
+    }
+    void ensureLUT() const {
+        if (lutStale_.load(std::memory_order_acquire)) updateLUT();
+    }
+    void updateLUT() const;
+
     std::vector<vec4> baseColors_;  // base colors to be interpolated
+    // The tables are filled by the first lookup after the base colors changed
+    mutable std::vector<vec4> lut_;
+    mutable std::vector<u8vec4> packedLut_;
+    mutable std::atomic<bool> lutStale_{true};
+    mutable std::mutex lutMutex_;
 };
 
 }  // namespace inviwo
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace inviwo {
+namespace TNM067 {
+
+/**
+ * \class ValueStatistics
+ * \brief Value range and histogram of a scalar image
+ * All values are normalized the same way as util::glm_convert_normalized, i.e. unsigned integers
+ * are divided by their maximum and floating point values are kept as they are, so they can be
+ * used directly as the range of the color mapping.
+ */
+struct ValueStatistics {
+    double min = 0.0;
+    double max = 1.0;
+    std::uint64_t count = 0;  // the number of values included, non-finite values are not
+
+    /**
+     * For 8 and 16 bit data bin i counts the value i exactly, for floating point data the bins
+     * split [min, max] evenly
+     */
+    std::vector<std::uint64_t> histogram;
+    bool exactBins = false;
+
+    /**
+     * Value below which the fraction p of all values lie, p = 0 gives min and p = 1 gives max
+     */
+    double percentile(double p) const {
+        if (count == 0 || histogram.empty() || !(p > 0.0)) return min;
+        if (p >= 1.0) return max;
+        const auto rank = static_cast<std::uint64_t>(std::ceil(p * count));
+        std::uint64_t sum = 0;
+        for (size_t i = 0; i < histogram.size(); ++i) {
+            sum += histogram[i];
+            if (sum >= rank) return binValue(i);
+        }
+        return max;
+    }
+
+private:
+    double binValue(size_t i) const {
+        if (exactBins) return static_cast<double>(i) / (histogram.size() - 1);
+        const double center = min + (max - min) * (i + 0.5) / histogram.size();
+        return std::min(std::max(center, min), max);
+    }
+};
+
+namespace detail {
+
+template <typename T>
+constexpr bool hasExactBins() {
+    return std::is_same<T, std::uint8_t>::value || std::is_same<T, std::uint16_t>::value;
+}
+
+template <typename T>
+double normalized(T v) {
+    if constexpr (std::is_floating_point<T>::value) {
+        return static_cast<double>(v);
+    } else {
+        return static_cast<double>(v) / std::numeric_limits<T>::max();
+    }
+}
+
+}  // namespace detail
+
+/**
+ * Whether computeStatistics() supports values of type T
+ */
+template <typename T>
+constexpr bool hasValueStatistics() {
+    return detail::hasExactBins<T>() || std::is_floating_point<T>::value;
+}
+
+/**
+ * Computes min, max and histogram of the count values in data. The values are split into chunks
+ * that parallelFor(chunkCount, f) processes by calling f(chunk) for every chunk, in any order and
+ * on any thread. Each chunk keeps its own partial result, which are merged afterwards, so the
+ * result does not depend on how the chunks are scheduled.
+ *
+ * For 8 and 16 bit data a single read of every value gives both the range and an exact
+ * histogram with one bin per possible value. Floating point data is read a second time, binning
+ * into floatBins bins once the range is known; with floatBins = 0 only the range is computed.
+ * Non-finite values, NaN and infinities, are ignored: they are neither counted nor part of the
+ * range or the histogram.
+ */
+template <typename T, typename ParallelFor>
+ValueStatistics computeStatistics(const T* data, size_t count, size_t chunkCount, size_t floatBins,
+                                  ParallelFor&& parallelFor) {
+    static_assert(hasValueStatistics<T>(),
+                  "Only 8 and 16 bit unsigned and floating point values are supported");
+    constexpr bool exact = detail::hasExactBins<T>();
+    size_t bins = floatBins;
+    if constexpr (exact) bins = size_t{std::numeric_limits<T>::max()} + 1;
+
+    chunkCount = std::max<size_t>(1, std::min(chunkCount, count));
+    const size_t chunkSize = (count + chunkCount - 1) / std::max<size_t>(1, chunkCount);
+    auto chunkRange = [&](size_t chunk) {
+        const size_t begin = std::min(count, chunk * chunkSize);
+        return std::make_pair(begin, std::min(count, begin + chunkSize));
+    };
+
+    struct Partial {
+        T min = std::numeric_limits<T>::max();
+        T max = std::numeric_limits<T>::lowest();
+        std::uint64_t count = 0;
+        std::vector<std::uint32_t> histogram;
+    };
+    std::vector<Partial> partials(chunkCount);
+
+    parallelFor(chunkCount, [&](size_t chunk) {
+        auto& partial = partials[chunk];
+        const auto range = chunkRange(chunk);
+        if constexpr (exact) {
+            // The histogram alone gives the range, min and max are found from it when merging
+            partial.histogram.assign(bins, 0);
+            for (size_t i = range.first; i < range.second; ++i) ++partial.histogram[data[i]];
+            partial.count = range.second - range.first;
+        } else {
+            for (size_t i = range.first; i < range.second; ++i) {
+                const T v = data[i];
+                if (!std::isfinite(v)) continue;
+                partial.min = std::min(partial.min, v);
+                partial.max = std::max(partial.max, v);
+                ++partial.count;
+            }
+        }
+    });
+
+    ValueStatistics stats;
+    stats.exactBins = exact;
+    T min = std::numeric_limits<T>::max();
+    T max = std::numeric_limits<T>::lowest();
+    for (const auto& partial : partials) stats.count += partial.count;
+    if (stats.count == 0) return stats;
+
+    if constexpr (exact) {
+        stats.histogram.assign(bins, 0);
+        for (const auto& partial : partials) {
+            for (size_t b = 0; b < bins; ++b) stats.histogram[b] += partial.histogram[b];
+        }
+        auto used = [](auto c) { return c > 0; };
+        const auto first = std::find_if(stats.histogram.begin(), stats.histogram.end(), used);
+        const auto last = std::find_if(stats.histogram.rbegin(), stats.histogram.rend(), used);
+        min = static_cast<T>(first - stats.histogram.begin());
+        max = static_cast<T>(stats.histogram.rend() - last - 1);
+    } else {
+        for (const auto& partial : partials) {
+            min = std::min(min, partial.min);
+            max = std::max(max, partial.max);
+        }
+    }
+    stats.min = detail::normalized(min);
+    stats.max = detail::normalized(max);
+
+    if constexpr (!exact) {
+        if (bins == 0) return stats;
+        const double scale = max > min ? bins / (static_cast<double>(max) - min) : 0.0;
+        parallelFor(chunkCount, [&](size_t chunk) {
+            auto& partial = partials[chunk];
+            const auto range = chunkRange(chunk);
+            partial.histogram.assign(bins, 0);
+            for (size_t i = range.first; i < range.second; ++i) {
+                const T v = data[i];
+                if (!std::isfinite(v)) continue;
+                const auto bin = static_cast<size_t>((static_cast<double>(v) - min) * scale);
+                ++partial.histogram[std::min(bin, bins - 1)];
+            }
+        });
+        stats.histogram.assign(bins, 0);
+        for (const auto& partial : partials) {
+            for (size_t b = 0; b < bins; ++b) stats.histogram[b] += partial.histogram[b];
+        }
+    }
+    return stats;
+}
+
+}  // namespace TNM067
+}  // namespace inviwo
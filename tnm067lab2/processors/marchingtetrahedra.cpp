@@ -48,33 +48,28 @@ MarchingTetrahedra::MarchingTetrahedra()
     });
 }
 
-vec3 MarchingTetrahedra::TriangleCreator::interpolatePosition(const DataPoint& dp1, const DataPoint& dp2) {
-    if(dp1.value == iso) return dp1.pos;
-    if(dp2.value == iso) return dp2.pos;
+float MarchingTetrahedra::TriangleCreator::interpolationParameter(const DataPoint& dp1,
+                                                                  const DataPoint& dp2) {
+    if(dp1.value == iso) return 0.0f;
+    if(dp2.value == iso) return 1.0f;
 
     // float interpolationValue = (iso - dp1.value) / (dp2.value - dp1.value);
     // if (dp1.value > dp2.value) interpolationValue = 1.0f - interpolationValue;
     // return (dp1.pos * (1.0f - interpolationValue)) + (dp2.pos * interpolationValue);
-    
-    return dp1.pos + ((dp2.pos - dp1.pos) * (iso - dp1.value)) / (dp2.value - dp1.value);
+
+    return (iso - dp1.value) / (dp2.value - dp1.value);
 }
 
 void MarchingTetrahedra::TriangleCreator::createTriangle(bool inverted, std::pair<int, int> line1, std::pair<int, int> line2, std::pair<int, int> line3) {
-    auto v0 = mesh.addVertex(
-        interpolatePosition(tetrahedra.dataPoints[line1.first], tetrahedra.dataPoints[line1.second]),
-        tetrahedra.dataPoints[line1.first].index,
-        tetrahedra.dataPoints[line1.second].index
-    );
-    auto v1 = mesh.addVertex(
-        interpolatePosition(tetrahedra.dataPoints[line2.first], tetrahedra.dataPoints[line2.second]),
-        tetrahedra.dataPoints[line2.first].index,
-        tetrahedra.dataPoints[line2.second].index
-    );
-    auto v2 = mesh.addVertex(
-        interpolatePosition(tetrahedra.dataPoints[line3.first], tetrahedra.dataPoints[line3.second]),
-        tetrahedra.dataPoints[line3.first].index,
-        tetrahedra.dataPoints[line3.second].index
-    );
+    auto addVertex = [&](std::pair<int, int> line) {
+        const DataPoint& from = tetrahedra.dataPoints[line.first];
+        const DataPoint& to = tetrahedra.dataPoints[line.second];
+        return mesh.addVertex(from.pos, to.pos, interpolationParameter(from, to), from.index,
+                              to.index);
+    };
+    auto v0 = addVertex(line1);
+    auto v1 = addVertex(line2);
+    auto v2 = addVertex(line3);
 
     if (inverted) {
         mesh.addTriangle(v0, v2, v1);
@@ -211,7 +206,9 @@ vec3 MarchingTetrahedra::calculateDataPointPos(size3_t posVolume, ivec3 posCell,
 
 MarchingTetrahedra::MeshHelper::MeshHelper(std::shared_ptr<const Volume> vol)
     : edgeToVertex_()
-    , vertices_()
+    , edgeFrom_()
+    , edgeTo_()
+    , edgeT_()
     , mesh_(std::make_shared<BasicMesh>())
     , indexBuffer_(mesh_->addIndexBuffer(DrawType::Triangles, ConnectivityType::None)) {
     mesh_->setModelMatrix(vol->getModelMatrix());
@@ -226,33 +223,56 @@ void MarchingTetrahedra::MeshHelper::addTriangle(size_t i0, size_t i1, size_t i2
     indexBuffer_->add(static_cast<glm::uint32_t>(i0));
     indexBuffer_->add(static_cast<glm::uint32_t>(i1));
     indexBuffer_->add(static_cast<glm::uint32_t>(i2));
-
-    const auto a = std::get<0>(vertices_[i0]);
-    const auto b = std::get<0>(vertices_[i1]);
-    const auto c = std::get<0>(vertices_[i2]);
-
-    const vec3 n = glm::normalize(glm::cross(b - a, c - a));
-    std::get<1>(vertices_[i0]) += n;
-    std::get<1>(vertices_[i1]) += n;
-    std::get<1>(vertices_[i2]) += n;
 }
 
 std::shared_ptr<BasicMesh> MarchingTetrahedra::MeshHelper::toBasicMesh() {
-    for (auto& vertex : vertices_) {
+    // Place all vertices on their edges at once, one batch per coordinate
+    const size_t count = edgeT_.size();
+    std::array<std::vector<float>, 3> pos;
+    for (size_t c = 0; c < 3; ++c) {
+        pos[c].resize(count);
+        TNM067::Interpolation::linear(edgeFrom_[c].data(), edgeTo_[c].data(), edgeT_.data(),
+                                      pos[c].data(), count);
+    }
+
+    std::vector<BasicMesh::Vertex> vertices(count);
+    for (size_t i = 0; i < count; ++i) {
+        const vec3 p{pos[0][i], pos[1][i], pos[2][i]};
+        vertices[i] = {p, vec3(0, 0, 0), p, vec4(0.7f, 0.7f, 0.7f, 1.0f)};
+    }
+
+    const auto& indices = indexBuffer_->getDataContainer();
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const auto a = std::get<0>(vertices[indices[i]]);
+        const auto b = std::get<0>(vertices[indices[i + 1]]);
+        const auto c = std::get<0>(vertices[indices[i + 2]]);
+
+        const vec3 n = glm::normalize(glm::cross(b - a, c - a));
+        std::get<1>(vertices[indices[i]]) += n;
+        std::get<1>(vertices[indices[i + 1]]) += n;
+        std::get<1>(vertices[indices[i + 2]]) += n;
+    }
+
+    for (auto& vertex : vertices) {
         // Normalize the normal of the vertex
         std::get<1>(vertex) = glm::normalize(std::get<1>(vertex));
     }
-    mesh_->addVertices(vertices_);
+    mesh_->addVertices(vertices);
     return mesh_;
 }
 
-std::uint32_t MarchingTetrahedra::MeshHelper::addVertex(vec3 pos, size_t i, size_t j) {
+std::uint32_t MarchingTetrahedra::MeshHelper::addVertex(vec3 from, vec3 to, float t, size_t i,
+                                                       size_t j) {
     IVW_ASSERT(i != j, "i and j should not be the same value");
     if (j < i) std::swap(i, j);
 
-    auto [edgeIt, inserted] = edgeToVertex_.try_emplace(std::make_pair(i, j), vertices_.size());
+    auto [edgeIt, inserted] = edgeToVertex_.try_emplace(std::make_pair(i, j), edgeT_.size());
     if (inserted) {
-        vertices_.push_back({pos, vec3(0, 0, 0), pos, vec4(0.7f, 0.7f, 0.7f, 1.0f)});
+        for (glm::length_t c = 0; c < 3; ++c) {
+            edgeFrom_[c].push_back(from[c]);
+            edgeTo_[c].push_back(to[c]);
+        }
+        edgeT_.push_back(t);
     }
     return static_cast<std::uint32_t>(edgeIt->second);
 }
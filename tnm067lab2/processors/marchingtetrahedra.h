@@ -8,6 +8,9 @@
 #include <inviwo/core/ports/meshport.h>
 #include <inviwo/core/datastructures/geometry/basicmesh.h>
 
+#include <array>
+#include <vector>
+
 namespace inviwo {
 
 class IVW_MODULE_TNM067LAB2_API MarchingTetrahedra : public Processor {
@@ -47,17 +50,24 @@ public:
          * the created vertex or the vertex that was created for this edge before. The DataPoint-index i
          * and j can be given in any order.
          *
-         * @param pos spatial position of the vertex
+         * The position of the vertex is not evaluated here, the edges are collected in structure of
+         * arrays form and all positions are interpolated in one batch in toBasicMesh().
+         *
+         * @param from spatial position of the DataPoint i
+         * @param to spatial position of the DataPoint j
+         * @param t position of the vertex along the edge, 0 at from and 1 at to
          * @param i DataPoint index of first DataPoint of the edge
          * @param j DataPoint index of second DataPoint of the edge
          */
-        std::uint32_t addVertex(vec3 pos, size_t i, size_t j);
+        std::uint32_t addVertex(vec3 from, vec3 to, float t, size_t i, size_t j);
         void addTriangle(size_t i0, size_t i1, size_t i2);
         std::shared_ptr<BasicMesh> toBasicMesh();
 
     private:
         std::unordered_map<std::pair<size_t, size_t>, size_t, HashFunc> edgeToVertex_;
-        std::vector<BasicMesh::Vertex> vertices_;
+        std::array<std::vector<float>, 3> edgeFrom_;  // one array per coordinate
+        std::array<std::vector<float>, 3> edgeTo_;
+        std::vector<float> edgeT_;
         std::shared_ptr<BasicMesh> mesh_;
         std::shared_ptr<IndexBufferRAM> indexBuffer_;
     };
@@ -91,7 +101,7 @@ private:
         void createTriangle(bool inverted, std::pair<int, int> line1, std::pair<int, int> line2, std::pair<int, int> line3);
 
     private:
-        vec3 interpolatePosition(const DataPoint& from, const DataPoint& to);
+        float interpolationParameter(const DataPoint& from, const DataPoint& to);
 
         MeshHelper& mesh;
         const Tetrahedra& tetrahedra;
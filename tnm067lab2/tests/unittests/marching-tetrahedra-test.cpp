@@ -32,6 +32,12 @@
 #include <gtest/gtest.h>
 #include <warn/pop>
 #include <modules/tnm067lab2/processors/marchingtetrahedra.h>
+#include <inviwo/core/datastructures/volume/volume.h>
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <vector>
 
 namespace inviwo {
 
@@ -137,4 +143,87 @@ TEST(MarchingTetrahedraTests, CalculateVoxelPos) {
 }
 #endif
 
+// The vertices of the triangles of a few tetrahedra, given as the two DataPoints of their edge.
+// Edges shared by several triangles, and an end point exactly at the iso value, are included.
+namespace {
+constexpr float testIso = 0.25f;
+const std::vector<MarchingTetrahedra::DataPoint> testDataPoints = {
+    {vec3(0, 0, 0), 0.0f, 0}, {vec3(1, 0, 0), 1.0f, 1},  {vec3(0, 1, 0), 0.8f, 2},
+    {vec3(0, 0, 1), 0.6f, 3}, {vec3(1, 1, -1), 1.0f, 4}, {vec3(1, 0, 1), 0.1f, 5},
+    {vec3(0, 1, 1), testIso, 6}};
+const std::vector<std::array<std::pair<size_t, size_t>, 3>> testTriangles = {
+    {{{0, 1}, {0, 2}, {0, 3}}},
+    {{{0, 1}, {0, 4}, {0, 2}}},
+    {{{1, 0}, {3, 0}, {3, 5}}},
+    {{{1, 0}, {3, 5}, {1, 5}}},
+    {{{2, 0}, {6, 0}, {3, 0}}}};
+}  // namespace
+
+// toBasicMesh() places the vertices in one batch after all triangles have been added. It has to
+// give the mesh that placing every vertex and accumulating the normals as they were added gave.
+TEST(MarchingTetrahedraTests, MeshHelperMatchesPerVertexPlacement) {
+    MarchingTetrahedra::MeshHelper helper(
+        std::make_shared<Volume>(size3_t(2), DataFloat32::get()));
+
+    // The per vertex reference: position interpolated on the edge when the vertex is added and
+    // face normals accumulated per triangle
+    std::map<std::pair<size_t, size_t>, std::uint32_t> edgeToVertex;
+    std::vector<vec3> expectedPositions;
+    std::vector<vec3> expectedNormals;
+    std::vector<std::uint32_t> expectedIndices;
+    auto referenceVertex = [&](const MarchingTetrahedra::DataPoint& a,
+                               const MarchingTetrahedra::DataPoint& b) {
+        const auto edge = std::make_pair(std::min(a.index, b.index), std::max(a.index, b.index));
+        auto [it, inserted] = edgeToVertex.try_emplace(
+            edge, static_cast<std::uint32_t>(expectedPositions.size()));
+        if (inserted) {
+            vec3 pos = a.pos + ((b.pos - a.pos) * (testIso - a.value)) / (b.value - a.value);
+            if (a.value == testIso) pos = a.pos;
+            if (b.value == testIso) pos = b.pos;
+            expectedPositions.push_back(pos);
+            expectedNormals.push_back(vec3(0));
+        }
+        return it->second;
+    };
+
+    for (const auto& triangle : testTriangles) {
+        std::array<std::uint32_t, 3> v;
+        std::array<std::uint32_t, 3> expected;
+        for (size_t k = 0; k < 3; ++k) {
+            const auto& a = testDataPoints[triangle[k].first];
+            const auto& b = testDataPoints[triangle[k].second];
+            float t = (testIso - a.value) / (b.value - a.value);
+            if (a.value == testIso) t = 0.0f;
+            if (b.value == testIso) t = 1.0f;
+            v[k] = helper.addVertex(a.pos, b.pos, t, a.index, b.index);
+            expected[k] = referenceVertex(a, b);
+        }
+        helper.addTriangle(v[0], v[1], v[2]);
+
+        const vec3 p0 = expectedPositions[expected[0]];
+        const vec3 n = glm::normalize(glm::cross(expectedPositions[expected[1]] - p0,
+                                                 expectedPositions[expected[2]] - p0));
+        for (auto i : expected) {
+            expectedNormals[i] += n;
+            expectedIndices.push_back(i);
+        }
+    }
+    for (auto& n : expectedNormals) n = glm::normalize(n);
+
+    const auto mesh = helper.toBasicMesh();
+    const auto& positions = mesh->getVertices()->getRAMRepresentation()->getDataContainer();
+    const auto& normals = mesh->getNormals()->getRAMRepresentation()->getDataContainer();
+    const auto& indices = mesh->getIndices(0)->getRAMRepresentation()->getDataContainer();
+
+    EXPECT_EQ(expectedIndices, indices);
+    ASSERT_EQ(expectedPositions.size(), positions.size());
+    ASSERT_EQ(expectedNormals.size(), normals.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        for (glm::length_t c = 0; c < 3; ++c) {
+            EXPECT_NEAR(expectedPositions[i][c], positions[i][c], 1e-6f) << "vertex " << i;
+            EXPECT_NEAR(expectedNormals[i][c], normals[i][c], 1e-5f) << "vertex " << i;
+        }
+    }
+}
+
 }  // namespace inviwo 